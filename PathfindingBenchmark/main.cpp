@@ -0,0 +1,289 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include "pathfinding.h"
+#include "hierarchical_search.h"
+#include "d_star_lite.h"
+#include "connected_components.h"
+#include "search_trace.h"
+#include "map_loader.h"
+#include "scenarios.h"
+
+// Runs every algorithm over a set of scenarios with no window and no observer, and writes one CSV line per
+// scenario/algorithm to stdout so that runs can be compared by a script.
+//
+// Usage: PathfindingBenchmark [--size N] [--queries N] [--movement 4|8|8-cut-one|8-cut-both] [--components on|off]
+//                             [--histograms file.csv] [--trace file.trace] [--scen file.scen --maps directory]...
+// Without --scen the generated scenarios are run: empty, random obstacles, a maze and rooms. The moving AI lab's
+// .scen files give optimal lengths for --movement 8, diagonal moves that do not cut corners. With it the paths found are
+// checked against those lengths, and the number that differ is written to stderr. --histograms writes the
+// distribution of every search stat for each scenario/algorithm, as the means in the main output hide the outliers.
+// --trace records every timed query to a trace the visual demo can replay. The searches then report to an observer, so
+// their times include the recording. The generated maps are saved next to it, file.empty_256.grid and so on, as the demo
+// only replays a search on the map it was made on. --components on turns away the queries whose end can not be reached
+// before any search starts, as an application would. It is off by default, as the turned away queries would count as
+// searches that cost nothing and pull the means down by however many of them each scenario has. The rejected column
+// gives that number. An algorithm that FindPath() swaps for another on a scenario's map, such as jump point search on
+// weighted terrain, has no line for that scenario, as it would only repeat the other algorithm's numbers.
+
+namespace
+{
+	const float kLengthTolerance = 1e-3f; // Relative, the .scen lengths are rounded and ours are summed in floats.
+
+	void PrintUsage()
+	{
+		std::cerr << "Usage: PathfindingBenchmark [--size N] [--queries N] [--movement 4|8|8-cut-one|8-cut-both] [--components on|off]" << std::endl
+			<< "                            [--histograms file.csv] [--trace file.trace] [--scen file.scen --maps directory]..." << std::endl;
+	}
+
+	void RunScenario(const Scenario &scenario, const ConnectedComponents *components, Algorithm algorithm, std::ostream *histogram_file, SearchTraceWriter *trace)
+	{
+		SearchState state;
+		HierarchicalPathfinder hierarchy; // Built once for the map before the timing starts, as an application would keep it.
+		Landmarks landmarks; // The same for the landmark tables.
+		DStarLite replanner; // Reset before each query, so it searches from scratch as FindPath() does, but in the same arrays.
+		if (algorithm == HIERARCHICAL_A_STAR)
+		{
+			hierarchy.Build(scenario.graph);
+		}
+		if (algorithm == A_STAR_LANDMARKS)
+		{
+			landmarks.Build(scenario.graph);
+		}
+		UInt32 rejected = 0;
+		auto search = [&](const PathQuery &query, SearchObserver *observer)
+		{
+			if (components != nullptr && !components->Connected(query.start, query.end))
+			{
+				rejected++;
+				return SearchResult(); // Unreachable, so there is nothing to search for.
+			}
+			if (algorithm == HIERARCHICAL_A_STAR)
+			{
+				return hierarchy.FindPath(scenario.graph, query.start, query.end, state, observer);
+			}
+			if (algorithm == A_STAR_LANDMARKS)
+			{
+				return LandmarkAStar(scenario.graph, query.start, query.end, landmarks, state, observer);
+			}
+			if (algorithm == D_STAR_LITE)
+			{
+				replanner.Reset();
+				return replanner.FindPath(scenario.graph, query.start, query.end, observer);
+			}
+			return FindPath(scenario.graph, query.start, query.end, algorithm, state, observer);
+		};
+		if (!scenario.queries.empty())
+		{
+			search(scenario.queries[0], nullptr); // Warm up, so the state has grown to fit the grid.
+			rejected = 0;
+		}
+		unsigned long long heap_operations = state.HeapOperations() + replanner.HeapOperations(); // D* Lite keeps its own open set.
+		// The .scen lengths only hold for the moves they were measured with. HPA*, and A* (Manhattan) which overestimates
+		// diagonal moves, are allowed to find longer paths but not shorter ones.
+		bool check_lengths = scenario.optimal_lengths.size() == scenario.queries.size() && scenario.graph.Movement() == EIGHT_CONNECTED &&
+			scenario.graph.CornerRule() == NO_CORNER_CUTTING && scenario.graph.CostData() == nullptr;
+		bool may_be_longer = (algorithm == HIERARCHICAL_A_STAR || algorithm == A_STAR_MANHATTAN);
+		SearchStatsHistogram histogram;
+		UInt32 paths_found = 0, wrong_lengths = 0;
+		double total_length = 0;
+		auto start_time = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < scenario.queries.size(); i++)
+		{
+			const PathQuery &query = scenario.queries[i];
+			if (trace != nullptr)
+			{
+				trace->BeginSearch(scenario.graph, algorithm, query.start, query.end);
+			}
+			SearchResult result = search(query, trace);
+			if (trace != nullptr)
+			{
+				trace->EndSearch(result);
+			}
+			histogram.Add(result);
+			if (result.path_found)
+			{
+				paths_found++;
+				total_length += result.path_length;
+			}
+			if (check_lengths)
+			{
+				float optimal = scenario.optimal_lengths[i], error = result.path_length - optimal;
+				if (!result.path_found || error < -kLengthTolerance * (1 + optimal) || (!may_be_longer && error > kLengthTolerance * (1 + optimal)))
+				{
+					wrong_lengths++;
+				}
+			}
+		}
+		double nanoseconds = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start_time).count();
+		heap_operations = state.HeapOperations() + replanner.HeapOperations() - heap_operations;
+		double query_count = scenario.queries.empty() ? 1.0 : static_cast<double>(scenario.queries.size());
+		std::cout << scenario.name << "," << AlgorithmName(algorithm) << "," << scenario.queries.size() << "," << rejected << "," << paths_found << ","
+			<< (paths_found > 0 ? total_length / paths_found : 0.0) << "," << nanoseconds / query_count << ","
+			<< histogram.Total(SearchStatsHistogram::NODES_EXPANDED) / query_count << "," << histogram.Total(SearchStatsHistogram::NODES_GENERATED) / query_count << ","
+			<< histogram.Total(SearchStatsHistogram::DECREASE_KEYS) / query_count << "," << histogram.Total(SearchStatsHistogram::REOPENS) / query_count << ","
+			<< histogram.Max(SearchStatsHistogram::PEAK_OPEN) << "," << histogram.Total(SearchStatsHistogram::PATH_TIME) / query_count << ","
+			<< heap_operations / query_count << "," << scenario.graph.MemoryUsage() << "," << state.MemoryUsage() + replanner.MemoryUsage() << "," << histogram.Max(SearchStatsHistogram::PEAK_MEMORY) << std::endl;
+		if (histogram_file != nullptr)
+		{
+			histogram.Write(*histogram_file, scenario.name + "/" + AlgorithmName(algorithm));
+		}
+		if (wrong_lengths > 0)
+		{
+			std::cerr << scenario.name << ", " << AlgorithmName(algorithm) << ": " << wrong_lengths << " of " << scenario.queries.size()
+				<< " paths differ from the optimal lengths in the .scen file" << std::endl;
+		}
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	UInt32 size = 256, query_count = 1000;
+	std::vector<std::string> scenario_files;
+	std::string map_directory = ".";
+	std::string map_prefix; // The trace's path without .trace, the generated maps are saved as this.name.grid.
+	bool use_components = false;
+	Connectivity connectivity = FOUR_CONNECTED;
+	CornerCutting corner_cutting = NO_CORNER_CUTTING;
+	std::ofstream histogram_file;
+	SearchTraceWriter trace;
+	for (int i = 1; i < argc; i += 2)
+	{
+		std::string option = argv[i];
+		if (option == "--help" || option == "-h")
+		{
+			PrintUsage();
+			return 0;
+		}
+		if (i + 1 == argc)
+		{
+			std::cerr << "No value given for " << option << std::endl;
+			PrintUsage();
+			return -1;
+		}
+		if (option == "--size")
+		{
+			size = static_cast<UInt32>(std::strtoul(argv[i + 1], nullptr, 10));
+		}
+		else if (option == "--queries")
+		{
+			query_count = static_cast<UInt32>(std::strtoul(argv[i + 1], nullptr, 10));
+		}
+		else if (option == "--scen")
+		{
+			scenario_files.push_back(argv[i + 1]);
+		}
+		else if (option == "--maps")
+		{
+			map_directory = argv[i + 1];
+		}
+		else if (option == "--components")
+		{
+			std::string value = argv[i + 1];
+			if (value != "on" && value != "off")
+			{
+				std::cerr << "Unknown value " << value << " for --components" << std::endl;
+				PrintUsage();
+				return -1;
+			}
+			use_components = (value == "on");
+		}
+		else if (option == "--movement")
+		{
+			std::string movement = argv[i + 1];
+			if (movement != "4" && movement != "8" && movement != "8-cut-one" && movement != "8-cut-both")
+			{
+				std::cerr << "Unknown movement " << movement << std::endl;
+				PrintUsage();
+				return -1;
+			}
+			connectivity = (movement == "4") ? FOUR_CONNECTED : EIGHT_CONNECTED;
+			corner_cutting = (movement == "8-cut-one") ? CUT_ONE_CORNER : ((movement == "8-cut-both") ? CUT_BOTH_CORNERS : NO_CORNER_CUTTING);
+		}
+		else if (option == "--histograms")
+		{
+			histogram_file.open(argv[i + 1]);
+			if (!histogram_file)
+			{
+				std::cerr << "Could not write " << argv[i + 1] << std::endl;
+				return -1;
+			}
+			SearchStatsHistogram::WriteHeader(histogram_file);
+		}
+		else if (option == "--trace")
+		{
+			if (!trace.Open(argv[i + 1]))
+			{
+				std::cerr << "Could not write " << argv[i + 1] << std::endl;
+				return -1;
+			}
+			map_prefix = argv[i + 1];
+			if (map_prefix.size() > 6 && map_prefix.compare(map_prefix.size() - 6, 6, ".trace") == 0)
+			{
+				map_prefix.resize(map_prefix.size() - 6);
+			}
+		}
+		else
+		{
+			std::cerr << "Unknown option " << option << std::endl;
+			PrintUsage();
+			return -1;
+		}
+	}
+
+	std::cout << "scenario,algorithm,queries,rejected,paths_found,mean_path_length,ns_per_query,nodes_expanded_per_query,nodes_generated_per_query,decrease_keys_per_query,reopens_per_query,max_peak_open,path_ns_per_query,heap_ops_per_query,grid_bytes,state_bytes,max_peak_memory_bytes" << std::endl;
+	std::vector<Scenario> scenarios;
+	if (scenario_files.empty())
+	{
+		scenarios.push_back(EmptyScenario(size, query_count));
+		for (UInt32 density : { 10, 20, 30, 40 })
+		{
+			scenarios.push_back(RandomScenario(size, density, query_count));
+		}
+		scenarios.push_back(MazeScenario(size, query_count));
+		scenarios.push_back(RoomsScenario(size, 15, query_count));
+		scenarios.push_back(TerrainScenario(size, query_count));
+	}
+	for (const std::string &scenario_file : scenario_files)
+	{
+		Scenario scenario;
+		if (!LoadScenario(scenario_file, map_directory, scenario))
+		{
+			std::cerr << "Could not load " << scenario_file << std::endl;
+			return -1;
+		}
+		scenarios.push_back(scenario);
+	}
+	for (Scenario &scenario : scenarios)
+	{
+		scenario.graph.SetMovement(connectivity, corner_cutting);
+		if (trace.IsOpen() && scenario_files.empty() && !SaveGridFile(map_prefix + "." + scenario.name + ".grid", scenario.graph))
+		{
+			std::cerr << "Could not write the map of " << scenario.name << std::endl;
+			return -1;
+		}
+		ConnectedComponents components; // Like the hierarchy this is built before the timing starts.
+		if (use_components)
+		{
+			components.Build(scenario.graph);
+		}
+		for (int algorithm = 0; algorithm < kAlgorithmCount; algorithm++)
+		{
+			if (SearchedAlgorithm(scenario.graph, static_cast<Algorithm>(algorithm)) != algorithm)
+			{
+				continue; // FindPath() runs another algorithm instead, which is already measured under its own name.
+			}
+			RunScenario(scenario, use_components ? &components : nullptr, static_cast<Algorithm>(algorithm), histogram_file.is_open() ? &histogram_file : nullptr,
+				trace.IsOpen() ? &trace : nullptr);
+		}
+	}
+	if (!trace.Close())
+	{
+		std::cerr << "Could not write the whole trace" << std::endl;
+		return -1;
+	}
+	return 0;
+}
@@ -0,0 +1,215 @@
+#include "scenarios.h"
+#include "map_loader.h"
+#include <random>
+#include <algorithm>
+
+namespace
+{
+	const UInt32 kSeed = 2017; // Fixed so that every run of the benchmark uses the same maps and queries.
+
+	// Picks query_count pairs of free cells, they are not always connected to each other.
+	void AddRandomQueries(Scenario &scenario, UInt32 query_count, std::mt19937 &random)
+	{
+		std::vector<UInt32> free_cells;
+		for (UInt32 index = 0; index < scenario.graph.NodeCount(); index++)
+		{
+			if (!scenario.graph.Blocked(index))
+			{
+				free_cells.push_back(index);
+			}
+		}
+		if (free_cells.empty())
+		{
+			return;
+		}
+		std::uniform_int_distribution<size_t> pick(0, free_cells.size() - 1);
+		for (UInt32 i = 0; i < query_count; i++)
+		{
+			UInt32 start = free_cells[pick(random)];
+			UInt32 end = free_cells[pick(random)];
+			scenario.queries.push_back(PathQuery(start, end));
+		}
+	}
+}
+
+Scenario EmptyScenario(UInt32 size, UInt32 query_count)
+{
+	std::mt19937 random(kSeed);
+	Scenario scenario;
+	scenario.name = "empty_" + std::to_string(size);
+	scenario.graph = Grid(size, size);
+	AddRandomQueries(scenario, query_count, random);
+	return scenario;
+}
+
+Scenario RandomScenario(UInt32 size, UInt32 density_percent, UInt32 query_count)
+{
+	std::mt19937 random(kSeed + density_percent);
+	std::uniform_int_distribution<UInt32> percent(0, 99);
+	Scenario scenario;
+	scenario.name = "random" + std::to_string(density_percent) + "_" + std::to_string(size);
+	scenario.graph = Grid(size, size);
+	for (UInt32 index = 0; index < scenario.graph.NodeCount(); index++)
+	{
+		scenario.graph.SetBlocked(index, percent(random) < density_percent);
+	}
+	AddRandomQueries(scenario, query_count, random);
+	return scenario;
+}
+
+Scenario TerrainScenario(UInt32 size, UInt32 query_count)
+{
+	const UInt8 kRoad = 1, kGrass = 2, kMud = 4, kWater = 8; // The same costs as the demo's terrain.
+	const UInt32 kRoadSpacing = 32;
+	std::mt19937 random(kSeed);
+	Scenario scenario;
+	scenario.name = "terrain_" + std::to_string(size);
+	scenario.graph = Grid(size, size);
+	Grid &graph = scenario.graph;
+	for (UInt32 index = 0; index < graph.NodeCount(); index++)
+	{
+		graph.SetCost(index, kGrass);
+	}
+	std::uniform_int_distribution<UInt32> coordinate(0, size - 1), radius(2, std::max(size / 16, 2u));
+	UInt32 patch_count = std::max(size * size / 512, 1u);
+	for (UInt32 patch = 0; patch < patch_count; patch++) // Round patches, half of them mud and half water.
+	{
+		int centre_x = static_cast<int>(coordinate(random)), centre_y = static_cast<int>(coordinate(random));
+		int patch_radius = static_cast<int>(radius(random));
+		UInt8 cost = (patch % 2 == 0) ? kMud : kWater;
+		for (int y = std::max(centre_y - patch_radius, 0); y <= std::min(centre_y + patch_radius, static_cast<int>(size) - 1); y++)
+		{
+			for (int x = std::max(centre_x - patch_radius, 0); x <= std::min(centre_x + patch_radius, static_cast<int>(size) - 1); x++)
+			{
+				if ((x - centre_x) * (x - centre_x) + (y - centre_y) * (y - centre_y) <= patch_radius * patch_radius)
+				{
+					graph.SetCost(graph.Index(x, y), cost);
+				}
+			}
+		}
+	}
+	for (UInt32 y = 0; y < size; y++) // Roads go straight over everything else.
+	{
+		for (UInt32 x = 0; x < size; x++)
+		{
+			if (x % kRoadSpacing == kRoadSpacing / 2 || y % kRoadSpacing == kRoadSpacing / 2)
+			{
+				graph.SetCost(graph.Index(x, y), kRoad);
+			}
+		}
+	}
+	AddRandomQueries(scenario, query_count, random);
+	return scenario;
+}
+
+// Carves a maze with a depth first search over the cells with odd coordinates, knocking through the wall between
+// each cell and the next one visited.
+Scenario MazeScenario(UInt32 size, UInt32 query_count)
+{
+	std::mt19937 random(kSeed);
+	Scenario scenario;
+	scenario.name = "maze_" + std::to_string(size);
+	scenario.graph = Grid(size, size);
+	Grid &graph = scenario.graph;
+	for (UInt32 index = 0; index < graph.NodeCount(); index++)
+	{
+		graph.SetBlocked(index, true);
+	}
+	if (size < 3)
+	{
+		return scenario;
+	}
+	std::vector<UInt32> stack;
+	stack.push_back(graph.Index(1, 1));
+	graph.SetBlocked(stack.back(), false);
+	const int kSteps[4][2] = { { 0, -2 }, { -2, 0 }, { 2, 0 }, { 0, 2 } };
+	while (!stack.empty())
+	{
+		int x = static_cast<int>(graph.X(stack.back())), y = static_cast<int>(graph.Y(stack.back()));
+		int choices[4], choice_count = 0;
+		for (int i = 0; i < 4; i++)
+		{
+			int next_x = x + kSteps[i][0], next_y = y + kSteps[i][1];
+			if (next_x > 0 && next_y > 0 && next_x < static_cast<int>(size) - 1 && next_y < static_cast<int>(size) - 1 && graph.Blocked(graph.Index(next_x, next_y)))
+			{
+				choices[choice_count++] = i;
+			}
+		}
+		if (choice_count == 0)
+		{
+			stack.pop_back(); // Dead end, go back.
+			continue;
+		}
+		int step = choices[std::uniform_int_distribution<int>(0, choice_count - 1)(random)];
+		graph.SetBlocked(graph.Index(x + kSteps[step][0] / 2, y + kSteps[step][1] / 2), false); // The wall in between.
+		stack.push_back(graph.Index(x + kSteps[step][0], y + kSteps[step][1]));
+		graph.SetBlocked(stack.back(), false);
+	}
+	AddRandomQueries(scenario, query_count, random);
+	return scenario;
+}
+
+Scenario RoomsScenario(UInt32 size, UInt32 room_size, UInt32 query_count)
+{
+	std::mt19937 random(kSeed);
+	Scenario scenario;
+	scenario.name = "rooms" + std::to_string(room_size) + "_" + std::to_string(size);
+	scenario.graph = Grid(size, size);
+	Grid &graph = scenario.graph;
+	UInt32 pitch = room_size + 1; // A room and the wall on its right/bottom.
+	for (UInt32 y = 0; y < size; y++)
+	{
+		for (UInt32 x = 0; x < size; x++)
+		{
+			graph.SetBlocked(graph.Index(x, y), (x % pitch == room_size) || (y % pitch == room_size));
+		}
+	}
+	std::uniform_int_distribution<UInt32> door(0, room_size - 1);
+	for (UInt32 room_y = 0; room_y * pitch < size; room_y++)
+	{
+		for (UInt32 room_x = 0; room_x * pitch < size; room_x++)
+		{
+			UInt32 wall_x = room_x * pitch + room_size, wall_y = room_y * pitch + room_size;
+			UInt32 door_y = room_y * pitch + door(random), door_x = room_x * pitch + door(random);
+			if (wall_x < size && door_y < size)
+			{
+				graph.SetBlocked(graph.Index(wall_x, door_y), false); // Door in the right hand wall.
+			}
+			if (wall_y < size && door_x < size)
+			{
+				graph.SetBlocked(graph.Index(door_x, wall_y), false); // Door in the bottom wall.
+			}
+		}
+	}
+	AddRandomQueries(scenario, query_count, random);
+	return scenario;
+}
+
+bool LoadScenario(const std::string &scenario_path, const std::string &map_directory, Scenario &scenario)
+{
+	std::vector<ScenarioEntry> entries;
+	if (!LoadMovingAIScenario(scenario_path, entries) || entries.empty())
+	{
+		return false;
+	}
+	std::string map_name = entries.front().map_name;
+	size_t slash = map_name.find_last_of("/\\");
+	std::string map_file = (slash == std::string::npos) ? map_name : map_name.substr(slash + 1); // Maps are named relative to the benchmark set.
+	if (!LoadMovingAIMap(map_directory + "/" + map_file, scenario.graph))
+	{
+		return false;
+	}
+	scenario.name = map_file;
+	scenario.queries.clear();
+	scenario.optimal_lengths.clear();
+	for (const ScenarioEntry &entry : entries)
+	{
+		if (entry.map_name == map_name && entry.start_x < scenario.graph.Width() && entry.end_x < scenario.graph.Width() &&
+			entry.start_y < scenario.graph.Height() && entry.end_y < scenario.graph.Height())
+		{
+			scenario.queries.push_back(PathQuery(scenario.graph.Index(entry.start_x, entry.start_y), scenario.graph.Index(entry.end_x, entry.end_y)));
+			scenario.optimal_lengths.push_back(entry.optimal_length);
+		}
+	}
+	return true;
+}
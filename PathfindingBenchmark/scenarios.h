@@ -0,0 +1,22 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "grid.h"
+#include "batch_query.h"
+
+// A map and the queries to run on it. Generated scenarios are the same every run for the same arguments.
+struct Scenario
+{
+	std::string name;
+	Grid graph;
+	std::vector<PathQuery> queries;
+	std::vector<float> optimal_lengths; // Of each query, from a .scen file, for 8-connected moves without corner cutting. Empty for the generated scenarios.
+};
+
+Scenario EmptyScenario(UInt32 size, UInt32 query_count);
+Scenario RandomScenario(UInt32 size, UInt32 density_percent, UInt32 query_count); // Each cell is blocked with this chance.
+Scenario MazeScenario(UInt32 size, UInt32 query_count); // Corridors one cell wide, with exactly one route between any two cells.
+Scenario RoomsScenario(UInt32 size, UInt32 room_size, UInt32 query_count); // Square rooms joined by one door in each wall.
+Scenario TerrainScenario(UInt32 size, UInt32 query_count); // Grass with patches of mud and water crossed by roads, no obstacles.
+// Loads a MovingAI .scen file and the map it uses, which is looked for in map_directory.
+bool LoadScenario(const std::string &scenario_path, const std::string &map_directory, Scenario &scenario);
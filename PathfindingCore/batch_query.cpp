@@ -0,0 +1,143 @@
+#include "batch_query.h"
+#include <algorithm>
+
+BatchPathfinder::BatchPathfinder(UInt32 thread_count)
+	: hierarchy_version_(0), batch_number_(0), workers_running_(0), stopping_(false), graph_(nullptr), queries_(nullptr), results_(nullptr), algorithm_(DIJKSTRA), components_(nullptr)
+{
+	if (thread_count == 0)
+	{
+		thread_count = std::max(1u, std::thread::hardware_concurrency()); // This can be 0 if it is not known.
+	}
+	states_.resize(thread_count);
+	hierarchies_.resize(thread_count);
+	replanners_.resize(thread_count);
+	shares_.reset(new WorkShare[thread_count]);
+	for (UInt32 worker = 0; worker < thread_count; worker++)
+	{
+		shares_[worker].next = 0;
+		shares_[worker].end = 0;
+	}
+	for (UInt32 worker = 0; worker < thread_count; worker++)
+	{
+		threads_.push_back(std::thread(&BatchPathfinder::WorkerLoop, this, worker));
+	}
+}
+
+BatchPathfinder::~BatchPathfinder()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stopping_ = true;
+	}
+	batch_started_.notify_all();
+	for (std::thread &thread : threads_)
+	{
+		thread.join();
+	}
+}
+
+void BatchPathfinder::FindPaths(const Grid &graph, const std::vector<PathQuery> &queries, Algorithm algorithm, std::vector<SearchResult> &results,
+	const ConnectedComponents *components)
+{
+	results.clear();
+	results.resize(queries.size());
+	if (queries.empty())
+	{
+		return;
+	}
+	UInt32 thread_count = ThreadCount();
+	if (algorithm == A_STAR_LANDMARKS && !landmarks_.UpToDate(graph))
+	{
+		landmarks_.Build(graph);
+	}
+	if (algorithm == HIERARCHICAL_A_STAR && hierarchy_version_ != graph.Version())
+	{
+		hierarchies_[0].Build(graph);
+		std::fill(hierarchies_.begin() + 1, hierarchies_.end(), hierarchies_[0]); // Copying is much quicker than building again.
+		hierarchy_version_ = graph.Version();
+	}
+	UInt32 query_count = static_cast<UInt32>(queries.size());
+	std::unique_lock<std::mutex> lock(mutex_);
+	for (UInt32 worker = 0; worker < thread_count; worker++) // Splits the queries in to equal shares.
+	{
+		shares_[worker].next = static_cast<UInt32>(static_cast<unsigned long long>(query_count) * worker / thread_count);
+		shares_[worker].end = static_cast<UInt32>(static_cast<unsigned long long>(query_count) * (worker + 1) / thread_count);
+	}
+	graph_ = &graph;
+	queries_ = queries.data();
+	results_ = results.data();
+	algorithm_ = algorithm;
+	components_ = components;
+	workers_running_ = thread_count;
+	batch_number_++;
+	batch_started_.notify_all();
+	batch_finished_.wait(lock, [this] { return workers_running_ == 0; });
+}
+
+void BatchPathfinder::WorkerLoop(UInt32 worker)
+{
+	UInt32 last_batch = 0;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			batch_started_.wait(lock, [this, last_batch] { return stopping_ || batch_number_ != last_batch; });
+			if (stopping_)
+			{
+				return;
+			}
+			last_batch = batch_number_;
+		}
+		AnswerQueries(worker);
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (--workers_running_ == 0)
+		{
+			batch_finished_.notify_one();
+		}
+	}
+}
+
+// Works through this worker's own share first, then steals from the others in turn.
+void BatchPathfinder::AnswerQueries(UInt32 worker)
+{
+	UInt32 thread_count = ThreadCount();
+	SearchState &state = states_[worker];
+	for (UInt32 offset = 0; offset < thread_count; offset++)
+	{
+		WorkShare &share = shares_[(worker + offset) % thread_count];
+		while (true)
+		{
+			UInt32 first = share.next.fetch_add(kChunkSize);
+			if (first >= share.end)
+			{
+				break; // This share is used up, next may have gone past the end but nothing reads it again this batch.
+			}
+			UInt32 last = std::min(first + kChunkSize, share.end);
+			for (UInt32 query = first; query < last; query++)
+			{
+				const PathQuery &path_query = queries_[query];
+				if (components_ != nullptr && !components_->Connected(path_query.start, path_query.end))
+				{
+					continue;
+				}
+				if (algorithm_ == HIERARCHICAL_A_STAR)
+				{
+					results_[query] = hierarchies_[worker].FindPath(*graph_, path_query.start, path_query.end, state);
+				}
+				else if (algorithm_ == D_STAR_LITE)
+				{
+					replanners_[worker].Reset();
+					results_[query] = replanners_[worker].FindPath(*graph_, path_query.start, path_query.end);
+				}
+				else if (algorithm_ == A_STAR_LANDMARKS)
+				{
+					results_[query] = LandmarkAStar(*graph_, path_query.start, path_query.end, landmarks_, state);
+				}
+				else
+				{
+					results_[query] = FindPath(*graph_, path_query.start, path_query.end, algorithm_, state);
+				}
+			}
+		}
+	}
+}
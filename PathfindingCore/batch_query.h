@@ -0,0 +1,74 @@
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <condition_variable>
+#include "pathfinding.h"
+#include "connected_components.h"
+#include "hierarchical_search.h"
+#include "d_star_lite.h"
+
+struct PathQuery
+{
+	UInt32 start;
+	UInt32 end;
+	PathQuery(UInt32 start_, UInt32 end_)
+		: start(start_), end(end_) {};
+};
+
+// Answers many path queries at once on a pool of worker threads. All the workers read the same grid, which must not be
+// changed while a batch is running, and each worker has its own SearchState so they never write to shared memory.
+//
+// Each worker is given an equal share of the queries and claims them a few at a time. A worker that runs out starts
+// claiming from the other workers' shares, so a share full of long queries does not hold up the batch.
+//
+// What FindPath() would build for every query is built once for the grid and kept between batches: the landmark
+// tables are shared by the workers, and each worker has its own copy of the HPA* abstraction. D* Lite searches each
+// query from scratch, as FindPath() does, but in arrays that each worker keeps.
+class BatchPathfinder
+{
+public:
+	static const UInt32 kChunkSize = 8; // Queries claimed at a time.
+
+	explicit BatchPathfinder(UInt32 thread_count = 0); // 0 uses one thread per hardware thread.
+	~BatchPathfinder();
+
+	UInt32 ThreadCount() const { return static_cast<UInt32>(threads_.size()); };
+	// Blocks until every query has been answered, results[i] is the answer to queries[i]. If components are given (built
+	// for this grid) queries between cells in different components are answered without a search.
+	void FindPaths(const Grid &graph, const std::vector<PathQuery> &queries, Algorithm algorithm, std::vector<SearchResult> &results,
+		const ConnectedComponents *components = nullptr);
+
+private:
+	struct WorkShare
+	{
+		std::atomic<UInt32> next; // Next unclaimed query, the owner and any thieves all claim with fetch_add.
+		UInt32 end;
+		char padding[56]; // Keeps each share on its own cache line so claiming does not slow the other workers down.
+	};
+
+	void WorkerLoop(UInt32 worker);
+	void AnswerQueries(UInt32 worker);
+
+	std::vector<std::thread> threads_;
+	std::vector<SearchState> states_; // One per worker, kept between batches so searches do not allocate.
+	std::vector<HierarchicalPathfinder> hierarchies_; // Likewise, built for the grid at hierarchy_version_.
+	std::vector<DStarLite> replanners_;
+	Landmarks landmarks_; // Only read while a batch runs, so the workers share it.
+	UInt64 hierarchy_version_; // Grid::Version() of the grid the hierarchies were built for, 0 before they are built.
+	std::unique_ptr<WorkShare[]> shares_;
+	std::mutex mutex_;
+	std::condition_variable batch_started_, batch_finished_;
+	UInt32 batch_number_; // Goes up by one for every batch, this is what wakes the workers.
+	UInt32 workers_running_;
+	bool stopping_;
+
+	// The batch being worked on, only valid while workers_running_ is not 0.
+	const Grid *graph_;
+	const PathQuery *queries_;
+	SearchResult *results_;
+	Algorithm algorithm_;
+	const ConnectedComponents *components_;
+};
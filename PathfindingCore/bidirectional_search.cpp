@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <limits>
+#include "pathfinding.h"
+#include "search_state.h"
+#include "search_policies.h"
+using namespace std;
+
+// Runs one search forwards from the start node and one backwards from the end node, always expanding whichever side has
+// the lower key at the top of its open set. Whenever a node reached by one side has already been reached by the other,
+// the two halves make a path, and the shortest of these so far is kept as best_length.
+//
+// For A* both sides use the average of the two heuristics (half the estimate to the end minus half the estimate to the start,
+// and the negative of that backwards). This keeps the keys of both sides consistent with each other, so for Dijkstra and
+// A* alike the search can stop once the two top keys add up to at least best_length: no path through a node that
+// is still open could be any shorter.
+namespace
+{
+	struct Side
+	{
+		SearchState &state;
+		SearchState &other;
+		bool forwards;
+		UInt32 target; // The node this side is heading for, the start node when searching backwards.
+		UInt32 source;
+	};
+
+	// Potential of a node for one side, the backwards potential is the negative of the forwards one.
+	template <typename Estimate>
+	float Potential(const Estimate &estimate, const Side &side, UInt32 node)
+	{
+		return 0.5f * (estimate(node, side.target) - estimate(node, side.source));
+	}
+
+	// The estimate, moves and report are compiled in to the loop, as they are for SearchKernel() in pathfinding.cpp.
+	template <typename Estimate, typename Connected, typename Report>
+	SearchResult BidirectionalKernel(const Grid &graph, UInt32 start, UInt32 end, const Estimate &estimate, Connected, Report report, SearchState &state)
+	{
+		SearchTimer timer; // Used to measure the time that the algorithm has been running.
+		SearchResult result;
+		if (graph.Blocked(start) || graph.Blocked(end))
+		{
+			result.duration = timer.Finish(result.stats);
+			return result; // Either side would step out of its blocked source, though nothing can step in to it.
+		}
+		SearchState &reverse_state = state.Reverse();
+		state.Begin(graph.NodeCount());
+		reverse_state.Begin(graph.NodeCount());
+		Side sides[2] = { { state, reverse_state, true, end, start }, { reverse_state, state, false, start, end } };
+		UInt32 neighbours[Grid::kMaxNeighbours];
+
+		for (Side &side : sides)
+		{
+			side.state.Open(side.source, 0, Potential(estimate, side, side.source), SearchState::kNoParent);
+			result.stats.nodes_generated++;
+			report.Opened(side.source);
+		}
+		float best_length = (start == end) ? 0 : numeric_limits<float>::infinity(); // Length of the shortest path found so far.
+		UInt32 meeting_node = start; // Where the two halves of that path join.
+		while (!state.OpenSet().Empty() && !reverse_state.OpenSet().Empty())
+		{
+			float forward_key = state.OpenSet().TopKey().f_cost;
+			float reverse_key = reverse_state.OpenSet().TopKey().f_cost;
+			if (forward_key + reverse_key >= best_length)
+			{
+				break; // The frontiers have met and nothing left could give a shorter path.
+			}
+			Side &side = (forward_key <= reverse_key) ? sides[0] : sides[1];
+			UInt32 current_node = side.state.OpenSet().Pop();
+			float current_distance = side.state.GCost(current_node);
+			side.state.Close(current_node);
+			result.nodes_expanded++;
+			UInt32 straight_count;
+			UInt32 neighbour_count = graph.Moves<Connected::value>(current_node, neighbours, straight_count);
+			for (UInt32 i = 0; i < neighbour_count; i++)
+			{
+				UInt32 next_node = neighbours[i];
+				if (side.state.Closed(next_node))
+				{
+					continue;
+				}
+				// Moving costs the cost of the cell being moved in to, backwards that is the current cell rather than the next one.
+				float total_distance = current_distance + graph.MoveCost(side.forwards ? next_node : current_node, i >= straight_count);
+				if (!side.state.InOpenSet(next_node))
+				{
+					side.state.Open(next_node, total_distance, Potential(estimate, side, next_node), current_node);
+					result.stats.nodes_generated++;
+					report.Opened(next_node);
+				}
+				else if (total_distance < side.state.GCost(next_node))
+				{
+					side.state.Relax(next_node, total_distance, current_node);
+					result.stats.decrease_keys++;
+					report.Relaxed(next_node);
+				}
+				else
+				{
+					continue;
+				}
+				if (side.other.Visited(next_node) && (total_distance + side.other.GCost(next_node) < best_length))
+				{
+					best_length = total_distance + side.other.GCost(next_node);
+					meeting_node = next_node;
+				}
+			}
+			report.Closed(current_node);
+			if (report.Cancelled())
+			{
+				best_length = numeric_limits<float>::infinity(); // The path found so far may not be the shortest.
+				break;
+			}
+		}
+		if (best_length < numeric_limits<float>::infinity())
+		{
+			timer.PathStarted();
+			// Trace path, from the meeting node back to the start and then on to the end.
+			for (UInt32 path_node = meeting_node; path_node != SearchState::kNoParent; path_node = state.Parent(path_node))
+			{
+				result.path.push_back(path_node);
+			}
+			std::reverse(result.path.begin(), result.path.end());
+			for (UInt32 path_node = reverse_state.Parent(meeting_node); path_node != SearchState::kNoParent; path_node = reverse_state.Parent(path_node))
+			{
+				result.path.push_back(path_node);
+			}
+			result.path_found = true;
+			result.path_length = best_length;
+		}
+		result.stats.peak_open = state.OpenSet().PeakSize() + reverse_state.OpenSet().PeakSize();
+		result.stats.peak_memory = state.MemoryUsage(); // Includes the reverse state.
+		result.duration = timer.Finish(result.stats);
+		return result;
+	}
+}
+
+SearchResult BidirectionalSearch(const Grid &graph, UInt32 start, UInt32 end, Algorithm heuristic, SearchState &state, SearchObserver *observer)
+{
+	if (heuristic == DIJKSTRA)
+	{
+		return DispatchSearch(graph, observer, [&](auto moves, auto report) { return BidirectionalKernel(graph, start, end, NoEstimate(), moves, report, state); });
+	}
+	if (heuristic == A_STAR_MANHATTAN)
+	{
+		return DispatchSearch(graph, observer, [&](auto moves, auto report) { return BidirectionalKernel(graph, start, end, ManhattanEstimate(graph), moves, report, state); });
+	}
+	return DispatchSearch(graph, observer, [&](auto moves, auto report) { return BidirectionalKernel(graph, start, end, DiagonalEstimate(graph), moves, report, state); });
+}
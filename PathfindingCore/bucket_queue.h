@@ -0,0 +1,90 @@
+#pragma once
+#include <vector>
+#include <cassert>
+
+// A monotone priority queue for small integer priorities (Dial 1969). Nodes go in to a bucket for their priority, and
+// since a search never pushes a priority below the one it last popped, or more than the largest step past it, the
+// buckets can be a ring just big enough to hold that range. Pushing and popping are O(1) apart from skipping empty
+// buckets, which happens at most once per priority on the way up, rather than the O(log n) of a comparison heap.
+//
+// There is no decrease-key: a node that is reached again with a lower priority is simply pushed again, and the search
+// skips the copies that come out after the node has been closed. Nodes with the same priority come out last in first out.
+class BucketQueue
+{
+public:
+	BucketQueue()
+		: mask_(0), current_(0), size_(0), peak_size_(0), operations_(0) {};
+
+	// Empties the queue for a search whose priorities start at lowest, and never go more than max_step past the last
+	// priority popped.
+	void Begin(unsigned int lowest, unsigned int max_step)
+	{
+		unsigned int bucket_count = 1;
+		while (bucket_count <= max_step)
+		{
+			bucket_count *= 2;
+		}
+		if (buckets_.size() < bucket_count)
+		{
+			buckets_.resize(bucket_count);
+		}
+		for (std::vector<unsigned int> &bucket : buckets_) // Keeps each bucket's memory for the next search.
+		{
+			bucket.clear();
+		}
+		mask_ = bucket_count - 1;
+		current_ = lowest;
+		size_ = 0;
+		peak_size_ = 0;
+	}
+
+	bool Empty() const { return size_ == 0; };
+	unsigned int Size() const { return size_; };
+	unsigned int PeakSize() const { return peak_size_; }; // Largest the queue has been since Begin(), copies included.
+	unsigned int TopPriority() const { return current_; }; // Of the last node popped.
+	unsigned long long Operations() const { return operations_; }; // Pushes and pops since the queue was made.
+	size_t MemoryUsage() const
+	{
+		size_t bytes = buckets_.capacity() * sizeof(std::vector<unsigned int>);
+		for (const std::vector<unsigned int> &bucket : buckets_)
+		{
+			bytes += bucket.capacity() * sizeof(unsigned int);
+		}
+		return bytes;
+	}
+
+	void Push(unsigned int index, unsigned int priority)
+	{
+		assert(priority >= current_ && priority - current_ <= mask_);
+		buckets_[priority & mask_].push_back(index);
+		size_++;
+		operations_++;
+		if (size_ > peak_size_)
+		{
+			peak_size_ = size_;
+		}
+	}
+
+	unsigned int Pop()
+	{
+		assert(size_ > 0);
+		while (buckets_[current_ & mask_].empty())
+		{
+			current_++;
+		}
+		std::vector<unsigned int> &bucket = buckets_[current_ & mask_];
+		unsigned int index = bucket.back();
+		bucket.pop_back();
+		size_--;
+		operations_++;
+		return index;
+	}
+
+private:
+	std::vector<std::vector<unsigned int>> buckets_;
+	unsigned int mask_; // Bucket count - 1, the count is a power of 2.
+	unsigned int current_; // Lowest priority that can still be in the queue.
+	unsigned int size_;
+	unsigned int peak_size_;
+	unsigned long long operations_;
+};
@@ -0,0 +1,322 @@
+#include <algorithm>
+#include "connected_components.h"
+
+namespace
+{
+	// The 8 cells around a cell in order, so each one is next to the one before it. The odd ones share a side with the cell.
+	const int kRing[8][2] = { { -1, -1 }, { 0, -1 }, { 1, -1 }, { 1, 0 }, { 1, 1 }, { 0, 1 }, { -1, 1 }, { -1, 0 } };
+	const UInt32 kFinished = 4; // Group of a piece that has been cut off and given its own label.
+}
+
+const UInt32 ConnectedComponents::kNoComponent;
+
+ConnectedComponents::ConnectedComponents()
+	: built_(false), component_count_(0), fill_number_(0)
+{
+}
+
+void ConnectedComponents::Build(const Grid &graph)
+{
+	labels_.assign(graph.NodeCount(), kNoComponent);
+	parents_.clear();
+	sizes_.clear();
+	component_count_ = 0;
+	std::vector<UInt32> &queue = pieces_[0];
+	UInt32 neighbours[Grid::kMaxNeighbours];
+	for (UInt32 index = 0; index < graph.NodeCount(); index++)
+	{
+		if (labels_[index] != kNoComponent || graph.Blocked(index))
+		{
+			continue;
+		}
+		UInt32 label = NewLabel(0);
+		component_count_++;
+		queue.clear();
+		queue.push_back(index);
+		labels_[index] = label;
+		for (size_t next = 0; next < queue.size(); next++)
+		{
+			UInt32 neighbour_count = graph.Neighbours(queue[next], neighbours);
+			for (UInt32 i = 0; i < neighbour_count; i++)
+			{
+				if (labels_[neighbours[i]] == kNoComponent)
+				{
+					labels_[neighbours[i]] = label;
+					queue.push_back(neighbours[i]);
+				}
+			}
+		}
+		sizes_[label] = static_cast<UInt32>(queue.size());
+	}
+	built_ = true;
+}
+
+void ConnectedComponents::CellChanged(const Grid &graph, UInt32 index)
+{
+	if (!built_)
+	{
+		return;
+	}
+	if (graph.NodeCount() != labels_.size())
+	{
+		Build(graph);
+		return;
+	}
+	bool blocked = graph.Blocked(index);
+	if (blocked == (labels_[index] == kNoComponent))
+	{
+		return; // Only the cost changed.
+	}
+	if (parents_.size() > 2 * labels_.size() + 64) // Splits leave unused labels behind, start again once there are too many.
+	{
+		Build(graph);
+		return;
+	}
+	if (blocked)
+	{
+		CellBlocked(graph, index);
+	}
+	else
+	{
+		CellUnblocked(graph, index);
+	}
+}
+
+UInt32 ConnectedComponents::Component(UInt32 index) const
+{
+	UInt32 label = labels_[index];
+	if (label == kNoComponent)
+	{
+		return kNoComponent;
+	}
+	while (parents_[label] != label)
+	{
+		label = parents_[label];
+	}
+	return label;
+}
+
+size_t ConnectedComponents::MemoryUsage() const
+{
+	size_t bytes = (labels_.capacity() + parents_.capacity() + sizes_.capacity() + visits_.capacity()) * sizeof(UInt32);
+	for (const std::vector<UInt32> &piece : pieces_)
+	{
+		bytes += piece.capacity() * sizeof(UInt32);
+	}
+	return bytes;
+}
+
+UInt32 ConnectedComponents::NewLabel(UInt32 size)
+{
+	UInt32 label = static_cast<UInt32>(parents_.size());
+	parents_.push_back(label);
+	sizes_.push_back(size);
+	return label;
+}
+
+UInt32 ConnectedComponents::Root(UInt32 label)
+{
+	while (parents_[label] != label)
+	{
+		parents_[label] = parents_[parents_[label]]; // Path halving.
+		label = parents_[label];
+	}
+	return label;
+}
+
+UInt32 ConnectedComponents::Join(UInt32 a, UInt32 b)
+{
+	if (sizes_[a] < sizes_[b]) // The smaller tree goes under the larger, so trees stay shallow.
+	{
+		std::swap(a, b);
+	}
+	parents_[b] = a;
+	sizes_[a] += sizes_[b];
+	component_count_--;
+	return a;
+}
+
+void ConnectedComponents::CellUnblocked(const Grid &graph, UInt32 index)
+{
+	UInt32 neighbours[Grid::kMaxNeighbours];
+	UInt32 neighbour_count = graph.Neighbours(index, neighbours);
+	UInt32 root = kNoComponent;
+	for (UInt32 i = 0; i < neighbour_count; i++)
+	{
+		UInt32 neighbour_root = Root(labels_[neighbours[i]]);
+		if (root == kNoComponent)
+		{
+			root = neighbour_root;
+		}
+		else if (neighbour_root != root)
+		{
+			root = Join(root, neighbour_root);
+		}
+	}
+	if (root == kNoComponent) // On its own.
+	{
+		labels_[index] = NewLabel(1);
+		component_count_++;
+		return;
+	}
+	labels_[index] = root;
+	sizes_[root]++;
+}
+
+void ConnectedComponents::CellBlocked(const Grid &graph, UInt32 index)
+{
+	UInt32 root = Root(labels_[index]);
+	labels_[index] = kNoComponent;
+	sizes_[root]--;
+	int x = static_cast<int>(graph.X(index)), y = static_cast<int>(graph.Y(index));
+	bool free[8];
+	int first_blocked = -1;
+	for (int i = 0; i < 8; i++)
+	{
+		free[i] = graph.Walkable(x + kRing[i][0], y + kRing[i][1]);
+		if (!free[i] && first_blocked == -1)
+		{
+			first_blocked = i;
+		}
+	}
+	if (first_blocked == -1)
+	{
+		return; // Everything around is free, so the cells either side are still joined around it.
+	}
+	// Number the runs of free cells going round the ring, the neighbours in one run are still joined to each other.
+	int runs[8];
+	int run_count = 0;
+	for (int step = 1; step <= 8; step++)
+	{
+		int i = (first_blocked + step) % 8;
+		if (free[i])
+		{
+			if (!free[(i + 7) % 8])
+			{
+				run_count++;
+			}
+			runs[i] = run_count - 1;
+		}
+	}
+	// One neighbour from each run, these might have been joined only through the cell that is now blocked. With diagonal
+	// moves that is any cell of the ring in the same component, as they could also have been joined by a diagonal move
+	// past its corner, which the corner rules may no longer allow.
+	UInt32 starts[4];
+	int piece_count = 0;
+	unsigned int runs_seen = 0;
+	bool diagonal = (graph.Movement() == EIGHT_CONNECTED);
+	for (int i = diagonal ? 0 : 1; i < 8; i += diagonal ? 1 : 2)
+	{
+		if (free[i] && !(runs_seen & (1u << runs[i])))
+		{
+			UInt32 cell = graph.Index(x + kRing[i][0], y + kRing[i][1]);
+			if (diagonal && Root(labels_[cell]) != root)
+			{
+				continue; // Never joined to it, a diagonal move it had past the cell was not allowed.
+			}
+			runs_seen |= 1u << runs[i];
+			starts[piece_count++] = cell;
+		}
+	}
+	if (piece_count == 0) // The component was just this cell.
+	{
+		component_count_--;
+	}
+	else if (piece_count > 1)
+	{
+		Split(graph, root, starts, piece_count);
+	}
+}
+
+void ConnectedComponents::Split(const Grid &graph, UInt32 root, const UInt32 starts[4], int piece_count)
+{
+	if (visits_.size() != labels_.size() || fill_number_ >= (kNoComponent >> 2))
+	{
+		visits_.assign(labels_.size(), 0);
+		fill_number_ = 0;
+	}
+	fill_number_++; // Forgets the last fill without clearing anything.
+	UInt32 fill = fill_number_ << 2;
+	UInt32 groups[4]; // Pieces that have met are in the same group.
+	size_t next[4];
+	for (int piece = 0; piece < piece_count; piece++)
+	{
+		pieces_[piece].clear();
+		pieces_[piece].push_back(starts[piece]);
+		visits_[starts[piece]] = fill + piece;
+		groups[piece] = piece;
+		next[piece] = 0;
+	}
+	int group_count = piece_count;
+	UInt32 neighbours[Grid::kMaxNeighbours];
+	while (group_count > 1)
+	{
+		// Each piece reaches one more cell in turn, so none of them gets far ahead of the others.
+		for (int piece = 0; piece < piece_count; piece++)
+		{
+			if (groups[piece] == kFinished || next[piece] == pieces_[piece].size())
+			{
+				continue;
+			}
+			UInt32 neighbour_count = graph.Neighbours(pieces_[piece][next[piece]++], neighbours);
+			for (UInt32 i = 0; i < neighbour_count; i++)
+			{
+				UInt32 visit = visits_[neighbours[i]];
+				if ((visit & ~3u) != fill)
+				{
+					visits_[neighbours[i]] = fill + piece;
+					pieces_[piece].push_back(neighbours[i]);
+				}
+				else if (groups[visit & 3] != groups[piece]) // Met another piece, so they are still joined.
+				{
+					UInt32 old_group = groups[visit & 3];
+					for (int other = 0; other < piece_count; other++)
+					{
+						if (groups[other] == old_group)
+						{
+							groups[other] = groups[piece];
+						}
+					}
+					group_count--;
+				}
+			}
+		}
+		// A group whose pieces have all run out of cells without meeting the others has been cut off.
+		for (int piece = 0; piece < piece_count && group_count > 1; piece++)
+		{
+			UInt32 group = groups[piece];
+			if (group == kFinished)
+			{
+				continue;
+			}
+			bool cut_off = true;
+			for (int other = 0; other < piece_count; other++)
+			{
+				if (groups[other] == group && next[other] != pieces_[other].size())
+				{
+					cut_off = false;
+				}
+			}
+			if (!cut_off)
+			{
+				continue;
+			}
+			UInt32 label = NewLabel(0);
+			component_count_++;
+			for (int other = 0; other < piece_count; other++)
+			{
+				if (groups[other] == group)
+				{
+					for (UInt32 cell : pieces_[other])
+					{
+						labels_[cell] = label;
+					}
+					sizes_[label] += static_cast<UInt32>(pieces_[other].size());
+					groups[other] = kFinished;
+				}
+			}
+			sizes_[root] -= sizes_[label];
+			group_count--;
+		}
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <vector>
+#include "grid.h"
+
+// Labels every free cell with the component it belongs to, as joined by the grid's moves, so whether there is any path
+// between two cells can be answered without a search. Without it a query for an unreachable cell expands everything that
+// can be reached before giving up, which makes those queries the slowest there are.
+//
+// Kept up to date through CellChanged(). Unblocking a cell joins the components around it with a union-find over the
+// labels, which costs almost nothing. Blocking a cell can split its component: if the cells either side of it are still
+// joined through the cells around it nothing needs doing, otherwise the pieces are flood filled side by side until all
+// but one have either met or run out, and the pieces that ran out are given new labels. So the work is bounded by the
+// size of the smaller pieces rather than the size of the map.
+class ConnectedComponents
+{
+public:
+	static const UInt32 kNoComponent = 0xFFFFFFFF; // Blocked cells are in no component.
+
+	ConnectedComponents();
+
+	void Build(const Grid &graph);
+	bool Built() const { return built_; };
+	void CellChanged(const Grid &graph, UInt32 index); // After the cell has been blocked or unblocked, cost changes are ignored.
+
+	UInt32 Component(UInt32 index) const;
+	// False if either cell is blocked, which is also when every search reports that there is no path.
+	bool Connected(UInt32 a, UInt32 b) const
+	{
+		UInt32 component = Component(a);
+		return (component != kNoComponent) && (component == Component(b));
+	};
+	UInt32 ComponentCount() const { return component_count_; };
+	size_t MemoryUsage() const;
+
+private:
+	UInt32 NewLabel(UInt32 size);
+	UInt32 Root(UInt32 label); // Also shortens the path to the root for next time.
+	UInt32 Join(UInt32 a, UInt32 b); // Roots of two different components, returns the root of the joined component.
+	void CellUnblocked(const Grid &graph, UInt32 index);
+	void CellBlocked(const Grid &graph, UInt32 index);
+	void Split(const Grid &graph, UInt32 root, const UInt32 starts[4], int piece_count);
+
+	bool built_;
+	std::vector<UInt32> labels_; // By cell, the component is the root of this label.
+	std::vector<UInt32> parents_; // By label, a root is its own parent.
+	std::vector<UInt32> sizes_; // By label, cells in the component while the label is a root.
+	UInt32 component_count_;
+
+	// Used to flood fill the pieces when a cell is blocked.
+	std::vector<UInt32> visits_; // By cell, (fill_number_ << 2) + piece for cells filled since fill_number_ was last changed.
+	UInt32 fill_number_;
+	std::vector<UInt32> pieces_[4]; // The cells reached by each fill, in the order they were reached.
+};
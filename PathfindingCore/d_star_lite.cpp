@@ -0,0 +1,264 @@
+#include <cstdlib>
+#include <algorithm>
+#include "d_star_lite.h"
+using namespace std;
+
+namespace
+{
+	const long long kUnit = 1 << 20; // A move that costs 1.
+	const long long kDiagonalUnit = 1482910; // A diagonal move that costs 1, root 2 units rounded.
+	const long long kNoDistance = 0x7FFFFFFFFFFFFFFFLL; // Unreachable.
+	// The 8 cells around a cell, the first 4 share a side with it.
+	const int kAround[8][2] = { { 0, -1 }, { -1, 0 }, { 1, 0 }, { 0, 1 }, { -1, -1 }, { 1, -1 }, { -1, 1 }, { 1, 1 } };
+}
+
+DStarLite::DStarLite()
+	: start_(0), end_(0), key_modifier_(0), width_(0), height_(0)
+{
+}
+
+void DStarLite::Reset()
+{
+	width_ = 0;
+	height_ = 0;
+}
+
+DStarLite::Distance DStarLite::MoveDistance(const Grid &graph, UInt32 cell, bool diagonal)
+{
+	return graph.Cost(cell) * (diagonal ? kDiagonalUnit : kUnit);
+}
+
+DStarLite::Distance DStarLite::Estimate(const Grid &graph, UInt32 node, UInt32 end)
+{
+	Distance dx = abs(static_cast<Distance>(graph.X(node)) - static_cast<Distance>(graph.X(end)));
+	Distance dy = abs(static_cast<Distance>(graph.Y(node)) - static_cast<Distance>(graph.Y(end)));
+	if (graph.Movement() == FOUR_CONNECTED)
+	{
+		return (dx + dy) * kUnit;
+	}
+	return (max(dx, dy) - min(dx, dy)) * kUnit + min(dx, dy) * kDiagonalUnit; // Octile distance, as DiagonalDistance().
+}
+
+DStarLite::Key DStarLite::CalculateKey(const Grid &graph, UInt32 node) const
+{
+	Distance distance = min(g_costs_[node], rhs_costs_[node]);
+	if (distance == kNoDistance)
+	{
+		return Key(kNoDistance, kNoDistance); // After everything that can reach the end.
+	}
+	return Key(distance + Estimate(graph, start_, node) + key_modifier_, distance);
+}
+
+DStarLite::Distance DStarLite::Lookahead(const Grid &graph, UInt32 node) const
+{
+	if (graph.Blocked(node))
+	{
+		return kNoDistance; // Nothing leaves a blocked cell.
+	}
+	UInt32 neighbours[Grid::kMaxNeighbours];
+	UInt32 straight_count;
+	UInt32 neighbour_count = graph.Neighbours(node, neighbours, straight_count);
+	Distance best = kNoDistance;
+	for (UInt32 i = 0; i < neighbour_count; i++)
+	{
+		if (g_costs_[neighbours[i]] != kNoDistance)
+		{
+			best = min(best, MoveDistance(graph, neighbours[i], i >= straight_count) + g_costs_[neighbours[i]]);
+		}
+	}
+	return best;
+}
+
+// Brings the rhs-value up to date, and puts the node in the open set if it is now inconsistent.
+void DStarLite::UpdateNode(const Grid &graph, UInt32 node, SearchObserver *observer)
+{
+	if (node != end_)
+	{
+		rhs_costs_[node] = Lookahead(graph, node);
+	}
+	bool queued = open_set_.Contains(node);
+	if (g_costs_[node] != rhs_costs_[node])
+	{
+		if (queued)
+		{
+			open_set_.Remove(node); // The key can go either way, so it is taken out and put back.
+		}
+		open_set_.Push(node, CalculateKey(graph, node));
+		if (queued)
+		{
+			stats_.decrease_keys++; // Not always a decrease, the key is just changed.
+		}
+		else
+		{
+			stats_.nodes_generated++;
+		}
+		if (observer != nullptr)
+		{
+			if (queued)
+			{
+				observer->NodeRelaxed(node);
+			}
+			else
+			{
+				observer->NodeOpened(node);
+			}
+		}
+	}
+	else if (queued)
+	{
+		open_set_.Remove(node);
+	}
+}
+
+bool DStarLite::ComputeShortestPath(const Grid &graph, SearchResult &result, SearchObserver *observer)
+{
+	UInt32 neighbours[Grid::kMaxNeighbours];
+	while (!open_set_.Empty() && (open_set_.TopKey() < CalculateKey(graph, start_) || rhs_costs_[start_] != g_costs_[start_]))
+	{
+		Key old_key = open_set_.TopKey();
+		UInt32 current_node = open_set_.Pop();
+		Key new_key = CalculateKey(graph, current_node);
+		if (old_key < new_key)
+		{
+			open_set_.Push(current_node, new_key); // The start node has moved since this key was worked out.
+			continue;
+		}
+		result.nodes_expanded++;
+		if (expanded_[current_node])
+		{
+			stats_.reopens++;
+		}
+		expanded_[current_node] = true;
+		bool over_consistent = g_costs_[current_node] > rhs_costs_[current_node];
+		g_costs_[current_node] = over_consistent ? rhs_costs_[current_node] : kNoDistance; // A shorter path is accepted, a longer one is raised and searched again.
+		if (!over_consistent)
+		{
+			UpdateNode(graph, current_node, observer);
+		}
+		UInt32 neighbour_count = graph.Neighbours(current_node, neighbours);
+		for (UInt32 i = 0; i < neighbour_count; i++) // Every neighbour can step in to this node, so their lookaheads may have changed.
+		{
+			UpdateNode(graph, neighbours[i], observer);
+		}
+		if (observer != nullptr)
+		{
+			observer->NodeClosed(current_node);
+			if (observer->Cancelled())
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+SearchResult DStarLite::FindPath(const Grid &graph, UInt32 start, UInt32 end, SearchObserver *observer)
+{
+	SearchTimer timer; // Used to measure the time that the algorithm has been running.
+	SearchResult result;
+	if (graph.Blocked(start) || graph.Blocked(end))
+	{
+		result.duration = timer.Finish(result.stats);
+		return result; // Leaves the distances as they are, the next query can still repair them.
+	}
+	if (width_ != graph.Width() || height_ != graph.Height() || end != end_)
+	{
+		// A new end node changes every distance, so the search starts again.
+		width_ = graph.Width();
+		height_ = graph.Height();
+		g_costs_.assign(graph.NodeCount(), kNoDistance);
+		rhs_costs_.assign(graph.NodeCount(), kNoDistance);
+		expanded_.assign(graph.NodeCount(), false);
+		open_set_.Clear();
+		stats_ = SearchStats();
+		start_ = start;
+		end_ = end;
+		key_modifier_ = 0;
+		rhs_costs_[end] = 0;
+		open_set_.Push(end, CalculateKey(graph, end));
+		if (observer != nullptr)
+		{
+			observer->NodeOpened(end);
+		}
+	}
+	else if (start != start_)
+	{
+		key_modifier_ += Estimate(graph, start_, start); // Every key in the open set is now at most this much too high.
+		start_ = start;
+	}
+	bool computed = ComputeShortestPath(graph, result, observer);
+
+	// Follow the distances down from the start node.
+	if (computed && g_costs_[start] != kNoDistance)
+	{
+		timer.PathStarted();
+		UInt32 neighbours[Grid::kMaxNeighbours];
+		UInt32 path_node = start;
+		result.path.push_back(start);
+		while (path_node != end && result.path.size() <= graph.NodeCount())
+		{
+			Distance best = kNoDistance;
+			UInt32 next = path_node;
+			UInt32 straight_count;
+			UInt32 neighbour_count = graph.Neighbours(path_node, neighbours, straight_count);
+			for (UInt32 i = 0; i < neighbour_count; i++)
+			{
+				if (g_costs_[neighbours[i]] == kNoDistance)
+				{
+					continue;
+				}
+				Distance distance = MoveDistance(graph, neighbours[i], i >= straight_count) + g_costs_[neighbours[i]];
+				if (distance < best)
+				{
+					best = distance;
+					next = neighbours[i];
+				}
+			}
+			if (next == path_node)
+			{
+				break;
+			}
+			path_node = next;
+			result.path.push_back(path_node);
+		}
+		result.path_found = (path_node == end);
+		result.path_length = result.path_found ? static_cast<float>(static_cast<double>(g_costs_[start]) / kUnit) : 0;
+		if (!result.path_found)
+		{
+			result.path.clear();
+		}
+	}
+	stats_.peak_open = open_set_.PeakSize();
+	stats_.peak_memory = MemoryUsage();
+	result.duration = timer.Finish(stats_);
+	result.stats = stats_;
+	stats_ = SearchStats();
+	open_set_.ResetPeak();
+	return result;
+}
+
+void DStarLite::CellChanged(const Grid &graph, UInt32 index)
+{
+	if (width_ != graph.Width() || height_ != graph.Height())
+	{
+		return; // Nothing has been searched yet.
+	}
+	// The edges in to and out of the cell have changed, which changes the lookahead of the cell and of its neighbours. With
+	// diagonal moves that includes the cells at its corners, and the corner rules can open or close a diagonal move past it.
+	UpdateNode(graph, index, nullptr);
+	int x = static_cast<int>(graph.X(index)), y = static_cast<int>(graph.Y(index));
+	int around_count = (graph.Movement() == FOUR_CONNECTED) ? 4 : 8;
+	for (int step = 0; step < around_count; step++)
+	{
+		int next_x = x + kAround[step][0], next_y = y + kAround[step][1];
+		if (next_x >= 0 && next_y >= 0 && next_x < static_cast<int>(graph.Width()) && next_y < static_cast<int>(graph.Height()))
+		{
+			UpdateNode(graph, graph.Index(next_x, next_y), nullptr);
+		}
+	}
+}
+
+size_t DStarLite::MemoryUsage() const
+{
+	return (g_costs_.capacity() + rhs_costs_.capacity()) * sizeof(Distance) + expanded_.capacity() / 8 + open_set_.MemoryUsage();
+}
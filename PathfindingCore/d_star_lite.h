@@ -0,0 +1,56 @@
+#pragma once
+#include <vector>
+#include "pathfinding.h"
+#include "indexed_heap.h"
+
+// D* Lite (Koenig and Likhachev 2002) keeps its search between queries and repairs it when the grid changes, instead of
+// searching again from scratch. It searches backwards from the end node, so g-costs are distances to the end and stay
+// valid when the start node moves. When cells change only the nodes whose distance to the end actually changed, and
+// that are close enough to the start to matter, are expanded again.
+//
+// The grid has to be told about every change through CellChanged(). Moving the end node starts a new search.
+class DStarLite
+{
+public:
+	DStarLite();
+
+	// nodes_expanded counts only the nodes expanded by this call, which is how much of the search had to be repaired. The
+	// stats count the same way, including the nodes queued by CellChanged() since the last call.
+	SearchResult FindPath(const Grid &graph, UInt32 start, UInt32 end, SearchObserver *observer = nullptr);
+	void CellChanged(const Grid &graph, UInt32 index); // After the cell has been blocked, unblocked or had its cost changed.
+	void Reset(); // The next FindPath searches from scratch.
+	size_t MemoryUsage() const;
+	unsigned long long HeapOperations() const { return open_set_.Operations(); }; // Since it was made, for measuring searches.
+
+private:
+	// Distances are kept in fixed point, so that two sums of the same moves are equal whatever order they were added up
+	// in, and keys can be compared exactly. Sums of root 2 in floats can differ in the last bits, which stops the search
+	// at the wrong node. Root 2 is rounded to the nearest unit, so a path can be longer than the shortest by about
+	// 3e-7 of its diagonal moves' cost, and a 64-bit sum has room for any path on any grid. The units are in the .cpp.
+	typedef long long Distance;
+
+	struct Key // Ordered by k1 (f-cost) then k2 (g-cost).
+	{
+		Distance k1, k2;
+		Key(Distance k1_, Distance k2_)
+			: k1(k1_), k2(k2_) {};
+		bool operator<(const Key &other) const { return (k1 < other.k1) || ((k1 == other.k1) && (k2 < other.k2)); };
+	};
+
+	static Distance MoveDistance(const Grid &graph, UInt32 cell, bool diagonal); // Grid::MoveCost() in units.
+	static Distance Estimate(const Grid &graph, UInt32 node, UInt32 end); // GridDistance() in units.
+	Key CalculateKey(const Grid &graph, UInt32 node) const;
+	Distance Lookahead(const Grid &graph, UInt32 node) const; // The rhs-value: the best distance to the end through a neighbour.
+	void UpdateNode(const Grid &graph, UInt32 node, SearchObserver *observer);
+	// Returns false if the observer cancelled it, the nodes left inconsistent stay in the open set for the next search.
+	bool ComputeShortestPath(const Grid &graph, SearchResult &result, SearchObserver *observer);
+
+	std::vector<Distance> g_costs_; // Distance to the end node, as of the last time the node was expanded.
+	std::vector<Distance> rhs_costs_; // One step lookahead of the g-cost, the node is consistent when they are equal.
+	IndexedHeap<Key> open_set_; // The inconsistent nodes.
+	UInt32 start_, end_;
+	Distance key_modifier_; // Added to the keys as the start node moves, so the keys in the open set stay valid lower bounds.
+	std::vector<bool> expanded_; // Nodes expanded since the search last started from scratch, to count the reopens.
+	SearchStats stats_; // Since the last FindPath().
+	UInt32 width_, height_; // Of the grid being searched, 0 before the first search.
+};
@@ -0,0 +1,115 @@
+#include <atomic>
+#include <cstring>
+#include "grid.h"
+
+namespace
+{
+	std::atomic<UInt64> last_version(0); // Shared by every grid, so no two grids are ever at the same version.
+
+	UInt64 NextVersion()
+	{
+		return ++last_version;
+	}
+}
+
+Grid::Grid()
+	: width_(0), height_(0), version_(NextVersion()), connectivity_(FOUR_CONNECTED), corner_cutting_(NO_CORNER_CUTTING)
+{
+}
+
+Grid::Grid(UInt32 width, UInt32 height)
+	: width_(width), height_(height), rows_(width, height), columns_(height, width), version_(NextVersion()), connectivity_(FOUR_CONNECTED), corner_cutting_(NO_CORNER_CUTTING)
+{
+}
+
+Grid::Grid(UInt32 width, UInt32 height, const UInt64 *rows, const UInt64 *columns, const UInt8 *costs)
+	: width_(width), height_(height), rows_(width, height, rows), columns_(height, width, columns), version_(NextVersion()), connectivity_(FOUR_CONNECTED), corner_cutting_(NO_CORNER_CUTTING)
+{
+	if (costs != nullptr)
+	{
+		costs_.assign(costs, costs + NodeCount());
+	}
+}
+
+void Grid::SetBlocked(UInt32 index, bool blocked)
+{
+	if (Blocked(index) == blocked)
+	{
+		return; // Already the way it was asked to be, the version stays the same.
+	}
+	UInt32 x = X(index), y = Y(index);
+	rows_.SetFree(x, y, !blocked);
+	columns_.SetFree(y, x, !blocked);
+	version_ = NextVersion();
+}
+
+bool Grid::SetCost(UInt32 index, UInt8 cost)
+{
+	if (cost == 0)
+	{
+		return false;
+	}
+	if (costs_.empty())
+	{
+		if (cost == 1)
+		{
+			return true;
+		}
+		costs_.assign(NodeCount(), 1);
+	}
+	if (costs_[index] != cost)
+	{
+		costs_[index] = cost;
+		version_ = NextVersion();
+	}
+	return true;
+}
+
+void Grid::ClearObstacles()
+{
+	rows_ = OccupancyBits(width_, height_);
+	columns_ = OccupancyBits(height_, width_);
+	version_ = NextVersion();
+}
+
+UInt64 Grid::ContentHash() const
+{
+	UInt64 hash = 0xCBF29CE484222325ULL;
+	auto add = [&hash](UInt64 word)
+	{
+		hash = (hash ^ word) * 0x9E3779B97F4A7C15ULL;
+		hash ^= hash >> 32;
+	};
+	add(width_);
+	add(height_);
+	const UInt64 *rows = rows_.Data();
+	for (size_t i = 0, count = OccupancyBits::WordCount(width_, height_); i < count; i++)
+	{
+		add(rows[i]);
+	}
+	// Eight costs at a time, a grid without costs hashes as if every cost were 1, as Cost() reads it.
+	size_t node_count = NodeCount();
+	for (size_t i = 0; i < node_count; i += 8)
+	{
+		size_t bytes = (node_count - i < 8) ? node_count - i : 8;
+		UInt64 word = 0x0101010101010101ULL >> (8 * (8 - bytes));
+		if (!costs_.empty())
+		{
+			word = 0;
+			std::memcpy(&word, &costs_[i], bytes);
+		}
+		add(word);
+	}
+	return hash;
+}
+
+void Grid::SetMovement(Connectivity connectivity, CornerCutting corner_cutting)
+{
+	if (connectivity == connectivity_ && corner_cutting == corner_cutting_)
+	{
+		return;
+	}
+	connectivity_ = connectivity;
+	corner_cutting_ = corner_cutting;
+	version_ = NextVersion(); // Every distance on the grid may have changed.
+}
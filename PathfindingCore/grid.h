@@ -0,0 +1,135 @@
+#pragma once
+#include <vector>
+#include "occupancy_bits.h"
+
+typedef unsigned char UInt8;
+
+enum Connectivity // Which moves are allowed between cells.
+{
+	FOUR_CONNECTED, // Up, down, left and right only.
+	EIGHT_CONNECTED // Diagonals as well, with a cost of root 2.
+};
+
+enum CornerCutting // Whether a diagonal move can pass the corner of a blocked cell, the two cells either side of the move.
+{
+	NO_CORNER_CUTTING, // Both of them have to be free.
+	CUT_ONE_CORNER, // One of them can be blocked.
+	CUT_BOTH_CORNERS // Both can be blocked, so a move can squeeze between two blocked cells that touch at a corner.
+};
+
+const float kSquareRoot2 = 1.41421356237f; // Following the google C++ style guide convention for naming constants.
+
+// A dense row-major grid. Every cell is identified by its index (y * width + x). Obstacles are kept as one bit per cell,
+// twice: once by rows and once by columns (the transpose), so that a straight scan in any direction reads 64 cells per
+// word. Traversal costs are one byte per cell, and are only allocated once a cost other than 1 is set. Neighbours are
+// worked out from the index rather than being stored, so a uniform grid costs 2 bits per cell whichever moves it allows.
+class Grid
+{
+public:
+	static const UInt32 kMaxNeighbours = 8;
+
+	Grid();
+	Grid(UInt32 width, UInt32 height);
+	Grid(UInt32 width, UInt32 height, const UInt64 *rows, const UInt64 *columns, const UInt8 *costs); // Copies data laid out as Rows(), Columns() and CostData() are, costs can be null but not 0.
+
+	UInt32 Width() const { return width_; };
+	UInt32 Height() const { return height_; };
+	UInt32 NodeCount() const { return width_ * height_; };
+	UInt32 Index(UInt32 x, UInt32 y) const { return y * width_ + x; };
+	UInt32 X(UInt32 index) const { return index % width_; };
+	UInt32 Y(UInt32 index) const { return index / width_; };
+
+	bool Blocked(UInt32 index) const { return !rows_.Free(static_cast<int>(X(index)), static_cast<int>(Y(index))); };
+	// Inside the grid and not blocked, the coordinates are signed so that the cells around the edge can be asked about.
+	bool Walkable(int x, int y) const { return (x >= 0) && (y >= 0) && (x < static_cast<int>(width_)) && (y < static_cast<int>(height_)) && rows_.Free(x, y); };
+	void SetBlocked(UInt32 index, bool blocked);
+	UInt8 Cost(UInt32 index) const { return costs_.empty() ? 1 : costs_[index]; }; // Cost of moving in to this cell.
+	// Returns false, leaving the cell as it was, for a cost of 0. Every move has to cost something or the heuristics,
+	// which assume at least 1 a step, would overestimate.
+	bool SetCost(UInt32 index, UInt8 cost);
+	void ClearObstacles();
+	// Changes whenever an obstacle or cost actually changes. Every grid gets versions no other grid has had, so a version
+	// identifies both the grid and its contents, and anything worked out from the grid can check it is still up to date.
+	UInt64 Version() const { return version_; };
+	// A hash of the size, the blocked cells and the costs, but not the moves. Unlike the version it is the same for grids
+	// that are the same wherever they came from, so files can say which map they were made on. Reads every cell.
+	UInt64 ContentHash() const;
+	// The moves every search on this grid takes, 4-connected by default. Changing them changes the version, anything kept
+	// up to date through CellChanged() (components, HPA*, D* Lite) has to be built again.
+	void SetMovement(Connectivity connectivity, CornerCutting corner_cutting = NO_CORNER_CUTTING);
+	Connectivity Movement() const { return connectivity_; };
+	CornerCutting CornerRule() const { return corner_cutting_; };
+
+	// Free cells by row, and by column with x and y swapped, for scanning a word at a time.
+	const OccupancyBits &Rows() const { return rows_; };
+	const OccupancyBits &Columns() const { return columns_; };
+	const UInt8 *CostData() const { return costs_.empty() ? nullptr : costs_.data(); }; // Null while every cost is 1.
+	size_t MemoryUsage() const { return rows_.MemoryUsage() + columns_.MemoryUsage() + costs_.capacity(); };
+
+	// Writes the cells that can be moved to from this one and returns how many there are. The straight moves (up, left,
+	// right, down) come first and straight_count is set to how many of them there are, the diagonal moves follow them.
+	UInt32 Neighbours(UInt32 index, UInt32 neighbours[kMaxNeighbours], UInt32 &straight_count) const
+	{
+		return (connectivity_ == EIGHT_CONNECTED) ? Moves<EIGHT_CONNECTED>(index, neighbours, straight_count) : Moves<FOUR_CONNECTED>(index, neighbours, straight_count);
+	}
+	UInt32 Neighbours(UInt32 index, UInt32 neighbours[kMaxNeighbours]) const
+	{
+		UInt32 straight_count;
+		return Neighbours(index, neighbours, straight_count);
+	}
+	// The same as Neighbours() with the connectivity fixed when it is compiled, for search loops that have already
+	// checked it matches Movement() and should not check it again for every node.
+	template <Connectivity kConnectivity>
+	UInt32 Moves(UInt32 index, UInt32 neighbours[kMaxNeighbours], UInt32 &straight_count) const
+	{
+		UInt32 count = 0;
+		int y = static_cast<int>(index / width_);
+		int x = static_cast<int>(index - y * width_);
+		UInt32 around = rows_.Around(x, y); // Outside the grid reads as blocked.
+		if (around & 1)
+		{
+			neighbours[count++] = index - width_;
+		}
+		if (around & 2)
+		{
+			neighbours[count++] = index - 1;
+		}
+		if (around & 4)
+		{
+			neighbours[count++] = index + 1;
+		}
+		if (around & 8)
+		{
+			neighbours[count++] = index + width_;
+		}
+		straight_count = count;
+		if (kConnectivity == EIGHT_CONNECTED)
+		{
+			// Up-left, up-right, down-left and down-right, with the straight moves either side of each as bits of around.
+			static const int kDiagonals[4][2] = { { -1, -1 }, { 1, -1 }, { -1, 1 }, { 1, 1 } };
+			static const UInt32 kSides[4] = { 1 | 2, 1 | 4, 8 | 2, 8 | 4 };
+			int sides_needed = 2 - static_cast<int>(corner_cutting_); // Free sides the corner rule needs.
+			for (int i = 0; i < 4; i++)
+			{
+				UInt32 free_sides = around & kSides[i];
+				int free_count = (free_sides == kSides[i]) ? 2 : ((free_sides != 0) ? 1 : 0);
+				if (free_count >= sides_needed && rows_.Free(x + kDiagonals[i][0], y + kDiagonals[i][1]))
+				{
+					neighbours[count++] = index + kDiagonals[i][1] * static_cast<int>(width_) + kDiagonals[i][0];
+				}
+			}
+		}
+		return count;
+	}
+	// Cost of moving in to the cell, a diagonal move is root 2 times as far as a straight one.
+	float MoveCost(UInt32 to, bool diagonal) const { return diagonal ? Cost(to) * kSquareRoot2 : Cost(to); };
+
+private:
+	UInt32 width_, height_;
+	OccupancyBits rows_; // Bit x of row y is set if the cell is free.
+	OccupancyBits columns_; // The same with x and y swapped.
+	std::vector<UInt8> costs_; // Empty for a uniform grid.
+	UInt64 version_;
+	Connectivity connectivity_;
+	CornerCutting corner_cutting_;
+};
@@ -0,0 +1,495 @@
+#include <limits>
+#include <algorithm>
+#include "hierarchical_search.h"
+using namespace std;
+
+namespace
+{
+	const float kInfinity = numeric_limits<float>::infinity();
+}
+
+HierarchicalPathfinder::HierarchicalPathfinder(UInt32 cluster_size)
+	: cluster_size_(max(cluster_size, 2u)), width_(0), height_(0), clusters_x_(0), clusters_y_(0),
+	cluster_x_(0), cluster_y_(0), cluster_width_(0), cluster_height_(0)
+{
+}
+
+void HierarchicalPathfinder::Build(const Grid &graph)
+{
+	width_ = graph.Width();
+	height_ = graph.Height();
+	clusters_x_ = (width_ + cluster_size_ - 1) / cluster_size_;
+	clusters_y_ = (height_ + cluster_size_ - 1) / cluster_size_;
+	UInt32 cluster_count = clusters_x_ * clusters_y_;
+	clusters_.assign(cluster_count, Cluster());
+	right_borders_.assign(cluster_count, std::vector<Transition>());
+	bottom_borders_.assign(cluster_count, std::vector<Transition>());
+	corner_borders_.assign(cluster_count, std::vector<Transition>());
+	for (UInt32 cluster = 0; cluster < cluster_count; cluster++)
+	{
+		BuildBorder(graph, cluster, true);
+		BuildBorder(graph, cluster, false);
+		BuildCorner(graph, cluster);
+	}
+	for (UInt32 cluster = 0; cluster < cluster_count; cluster++) // After all the borders, as each cluster uses the borders of its neighbours.
+	{
+		BuildCluster(graph, cluster);
+	}
+}
+
+void HierarchicalPathfinder::CellChanged(const Grid &graph, UInt32 index)
+{
+	if (!Built() || width_ != graph.Width() || height_ != graph.Height())
+	{
+		return; // Built from scratch by the next query.
+	}
+	UInt32 x = graph.X(index), y = graph.Y(index);
+	UInt32 cluster = ClusterOf(x, y);
+	UInt32 changed[4] = { cluster, cluster, cluster, cluster }; // This cluster, any neighbour that shares a border the cell is on, and the one diagonally across a corner it is on.
+	UInt32 x_in_cluster = x % cluster_size_, y_in_cluster = y % cluster_size_;
+	int step_x = 0, step_y = 0; // Towards the neighbouring clusters.
+	if (x_in_cluster == cluster_size_ - 1 && x + 1 < width_)
+	{
+		BuildBorder(graph, cluster, true);
+		step_x = 1;
+	}
+	else if (x_in_cluster == 0 && x > 0)
+	{
+		BuildBorder(graph, cluster - 1, true);
+		step_x = -1;
+	}
+	if (y_in_cluster == cluster_size_ - 1 && y + 1 < height_)
+	{
+		BuildBorder(graph, cluster, false);
+		step_y = 1;
+	}
+	else if (y_in_cluster == 0 && y > 0)
+	{
+		BuildBorder(graph, cluster - clusters_x_, false);
+		step_y = -1;
+	}
+	changed[1] = cluster + step_x;
+	changed[2] = cluster + step_y * static_cast<int>(clusters_x_);
+	if (step_x != 0 && step_y != 0) // A corner cell, it can open or close a squeeze through the point where the four clusters meet.
+	{
+		changed[3] = changed[2] + step_x;
+		BuildCorner(graph, min(min(changed[0], changed[1]), min(changed[2], changed[3]))); // The corner belongs to the cluster above and to the left of it.
+	}
+	for (int i = 0; i < 4; i++)
+	{
+		if (i == 0 || changed[i] != cluster)
+		{
+			BuildCluster(graph, changed[i]);
+		}
+	}
+}
+
+// Finds the runs of free cell pairs along the border, and places one or two transitions on each run.
+void HierarchicalPathfinder::BuildBorder(const Grid &graph, UInt32 cluster, bool right)
+{
+	std::vector<Transition> &transitions = right ? right_borders_[cluster] : bottom_borders_[cluster];
+	transitions.clear();
+	UInt32 cluster_x = cluster % clusters_x_, cluster_y = cluster / clusters_x_;
+	if ((right && cluster_x + 1 >= clusters_x_) || (!right && cluster_y + 1 >= clusters_y_))
+	{
+		return; // On the edge of the map.
+	}
+	// The border is walked along its length, the inside cell is on the last column/row of this cluster.
+	UInt32 first = right ? cluster_y * cluster_size_ : cluster_x * cluster_size_;
+	UInt32 last = min(first + cluster_size_, right ? height_ : width_);
+	UInt32 across = right ? (cluster_x + 1) * cluster_size_ - 1 : (cluster_y + 1) * cluster_size_ - 1;
+	UInt32 run_start = first;
+	for (UInt32 along = first; along <= last; along++)
+	{
+		bool open = false;
+		if (along < last)
+		{
+			UInt32 inside = right ? graph.Index(across, along) : graph.Index(along, across);
+			UInt32 outside = right ? inside + 1 : inside + width_;
+			open = !graph.Blocked(inside) && !graph.Blocked(outside);
+		}
+		if (open)
+		{
+			continue;
+		}
+		UInt32 run_length = along - run_start;
+		if (run_length > 0)
+		{
+			UInt32 positions[2] = { run_start + run_length / 2, 0 };
+			UInt32 position_count = 1;
+			if (run_length >= kMaxSingleEntrance)
+			{
+				positions[0] = run_start;
+				positions[1] = along - 1;
+				position_count = 2;
+			}
+			for (UInt32 i = 0; i < position_count; i++)
+			{
+				Transition transition;
+				transition.inside = right ? graph.Index(across, positions[i]) : graph.Index(positions[i], across);
+				transition.outside = right ? transition.inside + 1 : transition.inside + width_;
+				transition.diagonal = false;
+				transitions.push_back(transition);
+			}
+		}
+		run_start = along + 1;
+	}
+	if (graph.Movement() == EIGHT_CONNECTED && graph.CornerRule() == CUT_BOTH_CORNERS)
+	{
+		// A squeeze between two blocked cells crosses where no straight move can, so each one is a transition of its own.
+		for (UInt32 along = first; along + 1 < last; along++)
+		{
+			for (UInt32 side = 0; side < 2; side++) // From the inside cell at along to the outside cell after it, and the other way round.
+			{
+				UInt32 inside_along = along + side, outside_along = along + 1 - side;
+				Transition transition;
+				transition.inside = right ? graph.Index(across, inside_along) : graph.Index(inside_along, across);
+				transition.outside = right ? graph.Index(across + 1, outside_along) : graph.Index(outside_along, across + 1);
+				transition.diagonal = true;
+				UInt32 inside_corner = right ? graph.Index(across, outside_along) : graph.Index(outside_along, across);
+				UInt32 outside_corner = right ? graph.Index(across + 1, inside_along) : graph.Index(inside_along, across + 1);
+				if (!graph.Blocked(transition.inside) && !graph.Blocked(transition.outside) && graph.Blocked(inside_corner) && graph.Blocked(outside_corner))
+				{
+					transitions.push_back(transition);
+				}
+			}
+		}
+	}
+}
+
+// Squeezes diagonally through the point where the cluster meets the ones to its right, below and below right. Only
+// there is a squeeze not on a single border, so BuildBorder() can not find it.
+void HierarchicalPathfinder::BuildCorner(const Grid &graph, UInt32 cluster)
+{
+	std::vector<Transition> &transitions = corner_borders_[cluster];
+	transitions.clear();
+	UInt32 cluster_x = cluster % clusters_x_, cluster_y = cluster / clusters_x_;
+	if (cluster_x + 1 >= clusters_x_ || cluster_y + 1 >= clusters_y_ || graph.Movement() != EIGHT_CONNECTED || graph.CornerRule() != CUT_BOTH_CORNERS)
+	{
+		return; // With a corner free the crossing can be made by straight moves, which the borders already have.
+	}
+	UInt32 x = (cluster_x + 1) * cluster_size_, y = (cluster_y + 1) * cluster_size_; // The cell below and right of the point.
+	UInt32 above_left = graph.Index(x - 1, y - 1), above_right = graph.Index(x, y - 1), below_left = graph.Index(x - 1, y), below_right = graph.Index(x, y);
+	if (!graph.Blocked(above_left) && !graph.Blocked(below_right) && graph.Blocked(above_right) && graph.Blocked(below_left))
+	{
+		transitions.push_back({ above_left, below_right, true });
+	}
+	if (!graph.Blocked(above_right) && !graph.Blocked(below_left) && graph.Blocked(above_left) && graph.Blocked(below_right))
+	{
+		transitions.push_back({ above_right, below_left, true });
+	}
+}
+
+// Collects the entrances and exits of the cluster from its four borders and four corners, and works out the distances between them.
+void HierarchicalPathfinder::BuildCluster(const Grid &graph, UInt32 cluster)
+{
+	Cluster &data = clusters_[cluster];
+	data.entrances.clear();
+	data.exits.clear();
+	UInt32 cluster_x = cluster % clusters_x_, cluster_y = cluster / clusters_x_;
+	const std::vector<Transition> *borders[8] = {
+		&right_borders_[cluster], &bottom_borders_[cluster],
+		(cluster_x > 0) ? &right_borders_[cluster - 1] : nullptr, (cluster_y > 0) ? &bottom_borders_[cluster - clusters_x_] : nullptr,
+		&corner_borders_[cluster], (cluster_x > 0) ? &corner_borders_[cluster - 1] : nullptr,
+		(cluster_y > 0) ? &corner_borders_[cluster - clusters_x_] : nullptr, (cluster_x > 0 && cluster_y > 0) ? &corner_borders_[cluster - clusters_x_ - 1] : nullptr };
+	for (int border = 0; border < 8; border++)
+	{
+		if (borders[border] == nullptr)
+		{
+			continue;
+		}
+		for (const Transition &transition : *borders[border])
+		{
+			bool inside = (ClusterOf(graph, transition.inside) == cluster); // The left and top borders belong to the neighbour, so this cluster is on the outside.
+			if (!inside && ClusterOf(graph, transition.outside) != cluster)
+			{
+				continue; // A corner squeeze between the other two of the four clusters.
+			}
+			UInt32 from = inside ? transition.inside : transition.outside;
+			UInt32 to = inside ? transition.outside : transition.inside;
+			int entrance = EntranceIndex(cluster, from);
+			if (entrance < 0) // A corner cell can be an entrance on two borders.
+			{
+				entrance = static_cast<int>(data.entrances.size());
+				data.entrances.push_back(from);
+			}
+			Exit exit;
+			exit.from = static_cast<UInt32>(entrance);
+			exit.to = to;
+			exit.diagonal = transition.diagonal;
+			data.exits.push_back(exit);
+		}
+	}
+	size_t entrance_count = data.entrances.size();
+	data.distances.assign(entrance_count * entrance_count, kInfinity);
+	for (size_t i = 0; i < entrance_count; i++)
+	{
+		SearchCluster(graph, cluster, data.entrances[i], false);
+		for (size_t j = 0; j < entrance_count; j++)
+		{
+			data.distances[i * entrance_count + j] = ClusterDistance(graph, data.entrances[j]);
+		}
+	}
+}
+
+int HierarchicalPathfinder::EntranceIndex(UInt32 cluster, UInt32 cell) const
+{
+	const std::vector<UInt32> &entrances = clusters_[cluster].entrances;
+	for (size_t i = 0; i < entrances.size(); i++)
+	{
+		if (entrances[i] == cell)
+		{
+			return static_cast<int>(i);
+		}
+	}
+	return -1;
+}
+
+// Dijkstra's algorithm limited to one cluster, leaves the distance from the source to every cell of the cluster (or from
+// every cell to the source if reverse is set) in cluster_distances_, and the forward search tree in cluster_parents_.
+void HierarchicalPathfinder::SearchCluster(const Grid &graph, UInt32 cluster, UInt32 source, bool reverse)
+{
+	cluster_x_ = (cluster % clusters_x_) * cluster_size_;
+	cluster_y_ = (cluster / clusters_x_) * cluster_size_;
+	cluster_width_ = min(cluster_size_, width_ - cluster_x_);
+	cluster_height_ = min(cluster_size_, height_ - cluster_y_);
+	cluster_distances_.assign(cluster_width_ * cluster_height_, kInfinity);
+	cluster_parents_.resize(cluster_width_ * cluster_height_);
+	UInt32 neighbours[Grid::kMaxNeighbours];
+
+	UInt32 source_local = (graph.Y(source) - cluster_y_) * cluster_width_ + graph.X(source) - cluster_x_;
+	cluster_distances_[source_local] = 0;
+	cluster_parents_[source_local] = SearchState::kNoParent;
+	// With every move costing 1, cells come off a first in first out queue in order of distance, so the heap is not needed.
+	bool uniform = (graph.CostData() == nullptr) && (graph.Movement() == FOUR_CONNECTED);
+	cluster_queue_.clear();
+	size_t queue_front = 0;
+	if (uniform)
+	{
+		cluster_queue_.push_back(source_local);
+	}
+	else
+	{
+		cluster_open_set_.Push(source_local, 0);
+	}
+	while (uniform ? (queue_front < cluster_queue_.size()) : !cluster_open_set_.Empty())
+	{
+		UInt32 current_local = uniform ? cluster_queue_[queue_front++] : cluster_open_set_.Pop();
+		UInt32 current_node = graph.Index(cluster_x_ + current_local % cluster_width_, cluster_y_ + current_local / cluster_width_);
+		float current_distance = cluster_distances_[current_local];
+		UInt32 straight_count;
+		UInt32 neighbour_count = graph.Neighbours(current_node, neighbours, straight_count);
+		for (UInt32 i = 0; i < neighbour_count; i++)
+		{
+			UInt32 next_node = neighbours[i];
+			UInt32 next_x = graph.X(next_node) - cluster_x_, next_y = graph.Y(next_node) - cluster_y_; // Wraps round for cells left of or above the cluster.
+			if (next_x >= cluster_width_ || next_y >= cluster_height_)
+			{
+				continue; // Only the cluster's own cells are searched.
+			}
+			UInt32 next_local = next_y * cluster_width_ + next_x;
+			float total_distance = current_distance + graph.MoveCost(reverse ? current_node : next_node, i >= straight_count); // Backwards, the step is from the neighbour in to this cell.
+			if (uniform)
+			{
+				if (cluster_distances_[next_local] == kInfinity)
+				{
+					cluster_distances_[next_local] = total_distance;
+					cluster_parents_[next_local] = current_node;
+					cluster_queue_.push_back(next_local);
+				}
+			}
+			else if (total_distance < cluster_distances_[next_local])
+			{
+				bool queued = cluster_open_set_.Contains(next_local);
+				cluster_distances_[next_local] = total_distance;
+				cluster_parents_[next_local] = current_node;
+				if (queued)
+				{
+					cluster_open_set_.DecreaseKey(next_local, total_distance);
+				}
+				else
+				{
+					cluster_open_set_.Push(next_local, total_distance); // Distances only go down, so a cell that has been popped is never pushed again.
+				}
+			}
+		}
+	}
+}
+
+SearchResult HierarchicalPathfinder::FindPath(const Grid &graph, UInt32 start, UInt32 end, SearchState &state, SearchObserver *observer)
+{
+	SearchTimer timer; // Used to measure the time that the algorithm has been running.
+	SearchResult result;
+	if (graph.Blocked(start) || graph.Blocked(end))
+	{
+		result.duration = timer.Finish(result.stats);
+		return result; // The cluster searches would step out of a blocked start or end node, but nothing can step in to one.
+	}
+	if (width_ != graph.Width() || height_ != graph.Height())
+	{
+		Build(graph);
+	}
+	// The start and end nodes are joined to the entrances of their clusters for this query only.
+	UInt32 start_cluster = ClusterOf(graph, start), end_cluster = ClusterOf(graph, end);
+	const Cluster &start_data = clusters_[start_cluster];
+	const Cluster &end_data = clusters_[end_cluster];
+	SearchCluster(graph, start_cluster, start, false);
+	start_distances_.resize(start_data.entrances.size());
+	for (size_t i = 0; i < start_data.entrances.size(); i++)
+	{
+		start_distances_[i] = ClusterDistance(graph, start_data.entrances[i]);
+	}
+	float direct_distance = (start_cluster == end_cluster) ? ClusterDistance(graph, end) : kInfinity; // Without leaving the cluster.
+	end_distances_.resize(end_data.entrances.size());
+	SearchCluster(graph, end_cluster, end, true);
+	for (size_t i = 0; i < end_data.entrances.size(); i++)
+	{
+		end_distances_[i] = ClusterDistance(graph, end_data.entrances[i]);
+	}
+
+	// A* over the abstract graph, the nodes are cells so the search state is indexed the same way as for a flat search.
+	state.Begin(graph.NodeCount());
+	IndexedHeap<OpenSetKey> &open_set = state.OpenSet();
+	UInt32 current_node = start;
+	float current_distance = 0;
+	auto visit = [&](UInt32 next_node, float edge_length)
+	{
+		if (edge_length == kInfinity || state.Closed(next_node))
+		{
+			return;
+		}
+		float total_distance = current_distance + edge_length;
+		if (!state.InOpenSet(next_node))
+		{
+			state.Open(next_node, total_distance, GridDistance(graph, next_node, end), current_node);
+			result.stats.nodes_generated++;
+			if (observer != nullptr)
+			{
+				observer->NodeOpened(next_node);
+			}
+		}
+		else if (total_distance < state.GCost(next_node))
+		{
+			state.Relax(next_node, total_distance, current_node);
+			result.stats.decrease_keys++;
+			if (observer != nullptr)
+			{
+				observer->NodeRelaxed(next_node);
+			}
+		}
+	};
+	state.Open(start, 0, GridDistance(graph, start, end), SearchState::kNoParent);
+	result.stats.nodes_generated++;
+	if (observer != nullptr)
+	{
+		observer->NodeOpened(start);
+	}
+	while (!open_set.Empty())
+	{
+		current_node = open_set.Top();
+		current_distance = state.GCost(current_node);
+		if (current_node == end)
+		{
+			result.path_found = true;
+			break;
+		}
+		open_set.Pop();
+		state.Close(current_node);
+		result.nodes_expanded++;
+		UInt32 cluster = ClusterOf(graph, current_node);
+		const Cluster &data = clusters_[cluster];
+		if (current_node == start)
+		{
+			for (size_t i = 0; i < data.entrances.size(); i++)
+			{
+				visit(data.entrances[i], start_distances_[i]);
+			}
+			visit(end, direct_distance);
+		}
+		int entrance = EntranceIndex(cluster, current_node); // The start node can be an entrance as well.
+		if (entrance >= 0)
+		{
+			size_t entrance_count = data.entrances.size();
+			for (size_t i = 0; i < entrance_count; i++)
+			{
+				visit(data.entrances[i], data.distances[entrance * entrance_count + i]);
+			}
+			for (const Exit &exit : data.exits)
+			{
+				if (exit.from == static_cast<UInt32>(entrance))
+				{
+					visit(exit.to, graph.MoveCost(exit.to, exit.diagonal));
+				}
+			}
+			if (cluster == end_cluster)
+			{
+				visit(end, end_distances_[entrance]);
+			}
+		}
+		if (observer != nullptr)
+		{
+			observer->NodeClosed(current_node);
+			if (observer->Cancelled())
+			{
+				break;
+			}
+		}
+	}
+
+	// Refine the abstract path: steps inside a cluster are searched for again and traced, steps across a border are one move.
+	if (result.path_found)
+	{
+		timer.PathStarted();
+		std::vector<UInt32> abstract_path;
+		for (UInt32 node = end; node != SearchState::kNoParent; node = state.Parent(node))
+		{
+			abstract_path.push_back(node);
+		}
+		std::reverse(abstract_path.begin(), abstract_path.end());
+		result.path.push_back(start);
+		std::vector<UInt32> segment;
+		for (size_t i = 1; i < abstract_path.size(); i++)
+		{
+			UInt32 from = abstract_path[i - 1], to = abstract_path[i];
+			UInt32 cluster = ClusterOf(graph, from);
+			if (cluster != ClusterOf(graph, to))
+			{
+				result.path.push_back(to);
+				continue;
+			}
+			SearchCluster(graph, cluster, from, false);
+			segment.clear();
+			for (UInt32 node = to; node != from; node = cluster_parents_[(graph.Y(node) - cluster_y_) * cluster_width_ + graph.X(node) - cluster_x_])
+			{
+				segment.push_back(node);
+			}
+			result.path.insert(result.path.end(), segment.rbegin(), segment.rend());
+		}
+		result.path_length = state.GCost(end);
+	}
+	result.stats.peak_open = open_set.PeakSize();
+	result.stats.peak_memory = state.MemoryUsage() + MemoryUsage();
+	result.duration = timer.Finish(result.stats);
+	return result;
+}
+
+UInt32 HierarchicalPathfinder::EntranceCount() const
+{
+	UInt32 count = 0;
+	for (const Cluster &cluster : clusters_)
+	{
+		count += static_cast<UInt32>(cluster.entrances.size());
+	}
+	return count;
+}
+
+size_t HierarchicalPathfinder::MemoryUsage() const
+{
+	size_t bytes = clusters_.capacity() * sizeof(Cluster) + (right_borders_.capacity() + bottom_borders_.capacity() + corner_borders_.capacity()) * sizeof(std::vector<Transition>);
+	for (size_t i = 0; i < clusters_.size(); i++)
+	{
+		bytes += clusters_[i].entrances.capacity() * sizeof(UInt32) + clusters_[i].exits.capacity() * sizeof(Exit) + clusters_[i].distances.capacity() * sizeof(float);
+		bytes += (right_borders_[i].capacity() + bottom_borders_[i].capacity() + corner_borders_[i].capacity()) * sizeof(Transition);
+	}
+	return bytes;
+}
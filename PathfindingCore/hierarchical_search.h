@@ -0,0 +1,82 @@
+#pragma once
+#include <vector>
+#include "pathfinding.h"
+#include "indexed_heap.h"
+
+// Hierarchical pathfinding A* (HPA*, Botea, Muller and Schaeffer 2004). The grid is split in to square clusters, and the
+// cells where a path can cross from one cluster to the next become the nodes of a much smaller abstract graph, joined by
+// the shortest distances between the entrances of each cluster. A query searches the abstract graph and then fills in
+// the path inside each cluster it passes through, so the work grows with the number of clusters crossed rather than
+// with the area of the map.
+//
+// Paths can only cross between clusters at the chosen entrances, so they can be a few percent longer than the shortest
+// path. On an 8-connected grid that lets diagonal moves squeeze between blocked cells, each squeeze across a border is
+// an entrance of its own, including one through the point where four clusters meet. The abstraction is built on the
+// first query, after that it has to be told about every change to the grid through CellChanged(), which
+// rebuilds only the clusters that touch the changed cell.
+class HierarchicalPathfinder
+{
+public:
+	static const UInt32 kDefaultClusterSize = 16;
+	static const UInt32 kMaxSingleEntrance = 6; // Crossings narrower than this get one entrance in the middle, wider ones get one at each end.
+
+	explicit HierarchicalPathfinder(UInt32 cluster_size = kDefaultClusterSize);
+
+	void Build(const Grid &graph);
+	bool Built() const { return width_ != 0; };
+	void CellChanged(const Grid &graph, UInt32 index); // After the cell has been blocked, unblocked or had its cost changed.
+	// The abstract nodes are grid cells, so they are what the observer sees being opened and closed, and nodes_expanded
+	// counts abstract nodes. Builds the abstraction first if it was built for a grid of a different size.
+	SearchResult FindPath(const Grid &graph, UInt32 start, UInt32 end, SearchState &state, SearchObserver *observer = nullptr);
+
+	UInt32 ClusterSize() const { return cluster_size_; };
+	UInt32 EntranceCount() const; // Nodes in the abstract graph.
+	size_t MemoryUsage() const;
+
+private:
+	struct Transition // A pair of free cells either side of the border between two clusters.
+	{
+		UInt32 inside; // In the cluster to the left/above, or above for a corner.
+		UInt32 outside;
+		bool diagonal; // Squeezes between two blocked cells, rather than going straight across.
+	};
+
+	struct Exit // An edge from an entrance to the cell across the border, it costs what that cell costs to move in to.
+	{
+		UInt32 from; // Index in to the cluster's entrances.
+		UInt32 to;
+		bool diagonal;
+	};
+
+	struct Cluster
+	{
+		std::vector<UInt32> entrances; // Cells on the edge of the cluster.
+		std::vector<Exit> exits;
+		std::vector<float> distances; // From entrance i to entrance j at [i * entrances.size() + j], infinity if there is no path inside the cluster.
+	};
+
+	UInt32 ClusterOf(UInt32 x, UInt32 y) const { return (y / cluster_size_) * clusters_x_ + x / cluster_size_; };
+	UInt32 ClusterOf(const Grid &graph, UInt32 index) const { return ClusterOf(graph.X(index), graph.Y(index)); };
+	void BuildBorder(const Grid &graph, UInt32 cluster, bool right);
+	void BuildCorner(const Grid &graph, UInt32 cluster);
+	void BuildCluster(const Grid &graph, UInt32 cluster);
+	int EntranceIndex(UInt32 cluster, UInt32 cell) const; // -1 if the cell is not an entrance.
+	void SearchCluster(const Grid &graph, UInt32 cluster, UInt32 source, bool reverse);
+	float ClusterDistance(const Grid &graph, UInt32 cell) const { return cluster_distances_[(graph.Y(cell) - cluster_y_) * cluster_width_ + graph.X(cell) - cluster_x_]; };
+
+	UInt32 cluster_size_;
+	UInt32 width_, height_; // Of the grid the abstraction was built for, 0 before it is built.
+	UInt32 clusters_x_, clusters_y_;
+	std::vector<Cluster> clusters_;
+	std::vector<std::vector<Transition>> right_borders_; // The border of each cluster with the one to its right.
+	std::vector<std::vector<Transition>> bottom_borders_; // And with the one below it.
+	std::vector<std::vector<Transition>> corner_borders_; // Diagonal squeezes through the point at the bottom right of each cluster, from the cluster above it to the one below.
+
+	// The last search inside a single cluster, indexed by position in the cluster.
+	UInt32 cluster_x_, cluster_y_, cluster_width_, cluster_height_;
+	std::vector<float> cluster_distances_;
+	std::vector<UInt32> cluster_parents_;
+	IndexedHeap<float> cluster_open_set_;
+	std::vector<UInt32> cluster_queue_; // Used instead of the heap when every cost is 1.
+	std::vector<float> start_distances_, end_distances_; // From the start node to the entrances of its cluster, and from the entrances of the end node's cluster to it.
+};
@@ -0,0 +1,171 @@
+#pragma once
+#include <vector>
+#include <cassert>
+
+// An array backed d-ary min heap of node indices. The position of every node in the heap is stored so that
+// Contains() is O(1) and DecreaseKey() can sift the node up from where it is, rather than searching for it.
+// Key only needs operator<, Arity of 4 keeps the heap shallow while the children still share a cache line.
+template <typename Key, unsigned int Arity = 4>
+class IndexedHeap
+{
+public:
+	static const unsigned int kNotInHeap = 0xFFFFFFFF;
+
+	IndexedHeap()
+		: operations_(0), peak_size_(0) {};
+
+	bool Empty() const { return heap_.empty(); };
+	unsigned int Size() const { return static_cast<unsigned int>(heap_.size()); };
+	bool Contains(unsigned int index) const { return (index < positions_.size()) && (positions_[index] != kNotInHeap); };
+	unsigned int Top() const { return heap_.front().index; };
+	const Key &TopKey() const { return heap_.front().key; };
+	unsigned long long Operations() const { return operations_; }; // Pushes, pops, removes and decrease-keys since the heap was made.
+	unsigned int PeakSize() const { return peak_size_; }; // Largest the heap has been since it was made, cleared or ResetPeak() was called.
+	void ResetPeak() { peak_size_ = Size(); };
+	size_t MemoryUsage() const { return heap_.capacity() * sizeof(Entry) + positions_.capacity() * sizeof(unsigned int); };
+
+	void Push(unsigned int index, const Key &key)
+	{
+		assert(!Contains(index));
+		if (index >= positions_.size())
+		{
+			positions_.resize(index + 1, kNotInHeap); // Grows to fit the largest index seen, this only happens on the first few searches.
+		}
+		heap_.push_back(Entry(key, index));
+		operations_++;
+		if (heap_.size() > peak_size_)
+		{
+			peak_size_ = static_cast<unsigned int>(heap_.size());
+		}
+		SiftUp(static_cast<unsigned int>(heap_.size()) - 1);
+	}
+
+	// The new key must not be greater than the old one.
+	void DecreaseKey(unsigned int index, const Key &key)
+	{
+		assert(Contains(index));
+		unsigned int position = positions_[index];
+		assert(!(heap_[position].key < key));
+		heap_[position].key = key;
+		operations_++;
+		SiftUp(position);
+	}
+
+	unsigned int Pop()
+	{
+		unsigned int top = heap_.front().index;
+		positions_[top] = kNotInHeap;
+		operations_++;
+		Entry last = heap_.back();
+		heap_.pop_back();
+		if (!heap_.empty())
+		{
+			heap_.front() = last;
+			SiftDown(0);
+		}
+		return top;
+	}
+
+	// Takes a node out from anywhere in the heap, the last entry fills its place and is sifted whichever way it needs to go.
+	void Remove(unsigned int index)
+	{
+		assert(Contains(index));
+		unsigned int position = positions_[index];
+		positions_[index] = kNotInHeap;
+		operations_++;
+		Entry last = heap_.back();
+		heap_.pop_back();
+		if (position < heap_.size())
+		{
+			heap_[position] = last;
+			positions_[last.index] = position;
+			if (position > 0 && last.key < heap_[(position - 1) / Arity].key)
+			{
+				SiftUp(position);
+			}
+			else
+			{
+				SiftDown(position);
+			}
+		}
+	}
+
+	// Only the nodes still in the heap are touched, so this does not depend on the size of the graph.
+	void Clear()
+	{
+		for (const Entry &entry : heap_)
+		{
+			positions_[entry.index] = kNotInHeap;
+		}
+		heap_.clear();
+		peak_size_ = 0;
+	}
+
+private:
+	struct Entry
+	{
+		Key key;
+		unsigned int index;
+		Entry(const Key &key_, unsigned int index_)
+			: key(key_), index(index_) {};
+	};
+
+	// Moves the entry towards the root, the hole is shifted down rather than swapping at every level.
+	void SiftUp(unsigned int position)
+	{
+		Entry entry = heap_[position];
+		while (position > 0)
+		{
+			unsigned int parent = (position - 1) / Arity;
+			if (!(entry.key < heap_[parent].key))
+			{
+				break;
+			}
+			heap_[position] = heap_[parent];
+			positions_[heap_[position].index] = position;
+			position = parent;
+		}
+		heap_[position] = entry;
+		positions_[entry.index] = position;
+	}
+
+	void SiftDown(unsigned int position)
+	{
+		Entry entry = heap_[position];
+		unsigned int size = static_cast<unsigned int>(heap_.size());
+		while (true)
+		{
+			unsigned int first_child = position * Arity + 1;
+			if (first_child >= size)
+			{
+				break;
+			}
+			unsigned int last_child = (first_child + Arity < size) ? first_child + Arity : size;
+			unsigned int smallest = first_child;
+			for (unsigned int child = first_child + 1; child < last_child; child++)
+			{
+				if (heap_[child].key < heap_[smallest].key)
+				{
+					smallest = child;
+				}
+			}
+			if (!(heap_[smallest].key < entry.key))
+			{
+				break;
+			}
+			heap_[position] = heap_[smallest];
+			positions_[heap_[position].index] = position;
+			position = smallest;
+		}
+		heap_[position] = entry;
+		positions_[entry.index] = position;
+	}
+
+	std::vector<Entry> heap_; // Contiguous storage, so pushes don't allocate once the vector has grown.
+	std::vector<unsigned int> positions_; // Position of each node index in heap_, or kNotInHeap.
+	unsigned long long operations_;
+	unsigned int peak_size_;
+};
+
+template <typename Key, unsigned int Arity>
+const unsigned int IndexedHeap<Key, Arity>::kNotInHeap;
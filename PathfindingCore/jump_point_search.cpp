@@ -0,0 +1,333 @@
+#include <cmath>
+#include <algorithm>
+#include <climits>
+#include "pathfinding.h"
+#include "search_policies.h"
+#include "search_state.h"
+using namespace std;
+
+// Jump point search finds the same shortest paths as A* on a grid where every move costs the same, but it only adds the
+// "jump points" to the open set: the cells where a path might have to turn. Straight runs between them are scanned
+// without touching the open set, which is what saves the work on open maps.
+//
+// 8-connected moves never cut corners: a diagonal move needs both of the cells beside it to be free.
+// For 4-connected moves the vertical direction takes the place of the diagonal, so a path can turn from vertical to
+// horizontal anywhere, but only turns from horizontal to vertical next to the end of an obstacle.
+namespace
+{
+	const UInt32 kNoJumpPoint = 0xFFFFFFFF;
+	const int kNoTarget = INT_MIN;
+
+	// Scans along one line of bits from position from (not included) in direction step, 64 cells at a time. A cell is
+	// forced if the cell beside it on either neighbouring line is free but the one behind that is blocked. Returns the
+	// position of the first forced cell or of target, or kNoTarget if an obstacle or the edge of the grid comes first.
+	int ScanLine(const OccupancyBits &bits, int from, int line, int step, int target)
+	{
+		if (step > 0)
+		{
+			for (int first = from + 1; ; first += 64) // Cell first + i is in bit i.
+			{
+				UInt64 free = bits.Run(first, line);
+				UInt64 forced = (bits.Run(first, line - 1) & ~bits.Run(first - 1, line - 1)) | (bits.Run(first, line + 1) & ~bits.Run(first - 1, line + 1));
+				UInt64 stops = ~free | forced;
+				if (target >= first && target < first + 64)
+				{
+					stops |= 1ULL << (target - first);
+				}
+				if (stops != 0)
+				{
+					int bit = OccupancyBits::LowestBit(stops); // The nearest stop.
+					return ((free >> bit) & 1) ? first + bit : kNoTarget;
+				}
+			}
+		}
+		for (int last = from - 1; ; last -= 64) // Cell last - 63 + i is in bit i, so the scan runs from bit 63 down.
+		{
+			int first = last - 63;
+			UInt64 free = bits.Run(first, line);
+			UInt64 forced = (bits.Run(first, line - 1) & ~bits.Run(first + 1, line - 1)) | (bits.Run(first, line + 1) & ~bits.Run(first + 1, line + 1));
+			UInt64 stops = ~free | forced;
+			if (target >= first && target <= last)
+			{
+				stops |= 1ULL << (target - first);
+			}
+			if (stops != 0)
+			{
+				int bit = OccupancyBits::HighestBit(stops);
+				return ((free >> bit) & 1) ? first + bit : kNoTarget;
+			}
+		}
+	}
+
+	class JumpPointSearcher
+	{
+	public:
+		JumpPointSearcher(const Grid &graph, UInt32 end)
+			: graph_(graph), end_x_(static_cast<int>(graph.X(end))), end_y_(static_cast<int>(graph.Y(end))) {};
+
+		// Scans from (x, y) in the direction (dx, dy), returns the first jump point found or kNoJumpPoint.
+		template <typename Connected>
+		UInt32 Jump(int x, int y, int dx, int dy, Connected) const
+		{
+			if (Connected::value == EIGHT_CONNECTED)
+			{
+				return (dx != 0 && dy != 0) ? JumpDiagonal(x, y, dx, dy) : JumpStraight(x, y, dx, dy);
+			}
+			return (dy != 0) ? JumpVertical(x, y, dy) : JumpStraight(x, y, dx, 0);
+		}
+
+	private:
+		bool IsEnd(int x, int y) const { return (x == end_x_) && (y == end_y_); };
+
+		// Stops at the first cell with a forced neighbour, one that can only be reached optimally through this cell.
+		// Horizontal scans read the rows of occupancy bits and vertical scans read the columns.
+		UInt32 JumpStraight(int x, int y, int dx, int dy) const
+		{
+			if (dx != 0)
+			{
+				int jump_x = ScanLine(graph_.Rows(), x, y, dx, (y == end_y_) ? end_x_ : kNoTarget);
+				return (jump_x == kNoTarget) ? kNoJumpPoint : graph_.Index(jump_x, y);
+			}
+			int jump_y = ScanLine(graph_.Columns(), y, x, dy, (x == end_x_) ? end_y_ : kNoTarget);
+			return (jump_y == kNoTarget) ? kNoJumpPoint : graph_.Index(x, jump_y);
+		}
+
+		// A diagonal stops wherever one of its horizontal/vertical components would find a jump point.
+		UInt32 JumpDiagonal(int x, int y, int dx, int dy) const
+		{
+			while (true)
+			{
+				if (!graph_.Walkable(x + dx, y) || !graph_.Walkable(x, y + dy)) // No cutting corners.
+				{
+					return kNoJumpPoint;
+				}
+				x += dx;
+				y += dy;
+				if (!graph_.Walkable(x, y))
+				{
+					return kNoJumpPoint;
+				}
+				if (IsEnd(x, y) || (JumpStraight(x, y, dx, 0) != kNoJumpPoint) || (JumpStraight(x, y, 0, dy) != kNoJumpPoint))
+				{
+					return graph_.Index(x, y);
+				}
+			}
+		}
+
+		// 4-connected only, the vertical direction behaves like a diagonal: it stops wherever a horizontal scan finds a jump point.
+		UInt32 JumpVertical(int x, int y, int dy) const
+		{
+			while (true)
+			{
+				y += dy;
+				if (!graph_.Walkable(x, y))
+				{
+					return kNoJumpPoint;
+				}
+				if (IsEnd(x, y) || (JumpStraight(x, y, 1, 0) != kNoJumpPoint) || (JumpStraight(x, y, -1, 0) != kNoJumpPoint))
+				{
+					return graph_.Index(x, y);
+				}
+			}
+		}
+
+		const Grid &graph_;
+		int end_x_, end_y_;
+	};
+
+	struct Direction
+	{
+		int dx, dy;
+	};
+
+	// Works out which directions are worth scanning from a jump point, given the direction it was reached from.
+	// Returns how many directions were written.
+	template <typename Connected>
+	int PrunedDirections(const Grid &graph, int x, int y, int dx, int dy, Connected, Direction directions[8])
+	{
+		int count = 0;
+		if (dx == 0 && dy == 0) // The start node, everything is a natural neighbour.
+		{
+			for (int ny = -1; ny <= 1; ny++)
+			{
+				for (int nx = -1; nx <= 1; nx++)
+				{
+					if ((nx != 0 || ny != 0) && (Connected::value == EIGHT_CONNECTED || nx == 0 || ny == 0))
+					{
+						directions[count++] = { nx, ny };
+					}
+				}
+			}
+			return count;
+		}
+		if (Connected::value == FOUR_CONNECTED)
+		{
+			if (dy != 0) // Vertical, carry on or turn either way.
+			{
+				directions[count++] = { 0, dy };
+				directions[count++] = { 1, 0 };
+				directions[count++] = { -1, 0 };
+			}
+			else // Horizontal, carry on or turn where the cell behind is blocked.
+			{
+				directions[count++] = { dx, 0 };
+				if (graph.Walkable(x, y - 1) && !graph.Walkable(x - dx, y - 1))
+				{
+					directions[count++] = { 0, -1 };
+				}
+				if (graph.Walkable(x, y + 1) && !graph.Walkable(x - dx, y + 1))
+				{
+					directions[count++] = { 0, 1 };
+				}
+			}
+			return count;
+		}
+		if (dx != 0 && dy != 0) // Diagonal, the two components and the diagonal itself.
+		{
+			directions[count++] = { dx, 0 };
+			directions[count++] = { 0, dy };
+			directions[count++] = { dx, dy };
+		}
+		else if (dx != 0) // Horizontal, the jump only stopped here because a cell above/below is forced.
+		{
+			directions[count++] = { dx, 0 };
+			for (int side = -1; side <= 1; side += 2)
+			{
+				if (graph.Walkable(x, y + side) && !graph.Walkable(x - dx, y + side))
+				{
+					directions[count++] = { 0, side };
+					directions[count++] = { dx, side };
+				}
+			}
+		}
+		else // Vertical.
+		{
+			directions[count++] = { 0, dy };
+			for (int side = -1; side <= 1; side += 2)
+			{
+				if (graph.Walkable(x + side, y) && !graph.Walkable(x + side, y - dy))
+				{
+					directions[count++] = { side, 0 };
+					directions[count++] = { side, dy };
+				}
+			}
+		}
+		return count;
+	}
+
+	int Sign(int value)
+	{
+		return (value > 0) - (value < 0);
+	}
+
+	// Distance between two cells on the same straight or diagonal line.
+	float JumpDistance(int dx, int dy)
+	{
+		int steps = max(abs(dx), abs(dy));
+		return (dx != 0 && dy != 0) ? steps * kSquareRoot2 : static_cast<float>(steps);
+	}
+}
+
+// The moves and the report are compiled in to the loop as they are for SearchKernel() in pathfinding.cpp.
+template <typename Connected, typename Report>
+static SearchResult JumpPointKernel(const Grid &graph, UInt32 start, UInt32 end, Connected moves, Report report, SearchState &state)
+{
+	SearchTimer timer; // Used to measure the time that the algorithm has been running.
+	SearchResult result;
+	if (graph.Blocked(start) || graph.Blocked(end))
+	{
+		result.duration = timer.Finish(result.stats);
+		return result; // A jump would still set off from a blocked start node.
+	}
+	state.Begin(graph.NodeCount()); // Forgets the previous search without clearing anything.
+	IndexedHeap<OpenSetKey> &open_set = state.OpenSet(); // Ordered from lowest distance/f-cost.
+	JumpPointSearcher searcher(graph, end);
+	Direction directions[8];
+
+	// Manhattan distance is exact on an open 4-connected grid, as diagonal distance is on an 8-connected one.
+	float h_cost = (Connected::value == FOUR_CONNECTED) ? ManhattanDistance(graph, start, end) : DiagonalDistance(graph, start, end);
+	state.Open(start, 0, h_cost, SearchState::kNoParent); // Start node has no parent
+	result.stats.nodes_generated++;
+	report.Opened(start);
+	bool no_path = false;
+	while (no_path == false)
+	{
+		UInt32 current_node = open_set.Top();
+		float current_distance = state.GCost(current_node);
+		if (current_node == end)
+		{
+			break; // We have found a path.
+		}
+		open_set.Pop();
+		state.Close(current_node);
+		result.nodes_expanded++;
+		int x = static_cast<int>(graph.X(current_node)), y = static_cast<int>(graph.Y(current_node));
+		int dx = 0, dy = 0; // Direction this jump point was reached from, none for the start node.
+		UInt32 parent = state.Parent(current_node);
+		if (parent != SearchState::kNoParent)
+		{
+			dx = Sign(x - static_cast<int>(graph.X(parent)));
+			dy = Sign(y - static_cast<int>(graph.Y(parent)));
+		}
+		int direction_count = PrunedDirections(graph, x, y, dx, dy, moves, directions);
+		for (int i = 0; i < direction_count; i++)
+		{
+			UInt32 next_node = searcher.Jump(x, y, directions[i].dx, directions[i].dy, moves);
+			if (next_node == kNoJumpPoint || state.Closed(next_node))
+			{
+				continue;
+			}
+			int jump_x = static_cast<int>(graph.X(next_node)) - x, jump_y = static_cast<int>(graph.Y(next_node)) - y;
+			float total_distance = current_distance + JumpDistance(jump_x, jump_y);
+			if (!state.InOpenSet(next_node))
+			{
+				h_cost = (Connected::value == FOUR_CONNECTED) ? ManhattanDistance(graph, next_node, end) : DiagonalDistance(graph, next_node, end);
+				state.Open(next_node, total_distance, h_cost, current_node);
+				result.stats.nodes_generated++;
+				report.Opened(next_node);
+			}
+			else if (total_distance < state.GCost(next_node))
+			{
+				state.Relax(next_node, total_distance, current_node);
+				result.stats.decrease_keys++;
+				report.Relaxed(next_node);
+			}
+		}
+		report.Closed(current_node);
+		if (open_set.Empty() || report.Cancelled())
+		{
+			no_path = true;
+		}
+	}
+	// Trace path, the parents are jump points so the cells between them are filled back in.
+	if (no_path == false)
+	{
+		timer.PathStarted();
+		UInt32 path_node = end;
+		while (path_node != start)
+		{
+			UInt32 parent = state.Parent(path_node);
+			int step_x = Sign(static_cast<int>(graph.X(parent)) - static_cast<int>(graph.X(path_node)));
+			int step_y = Sign(static_cast<int>(graph.Y(parent)) - static_cast<int>(graph.Y(path_node)));
+			int step = step_y * static_cast<int>(graph.Width()) + step_x; // Index offset of one step towards the parent.
+			for (UInt32 node = path_node; node != parent; node += step)
+			{
+				result.path.push_back(node);
+			}
+			path_node = parent;
+		}
+		result.path.push_back(start);
+		std::reverse(result.path.begin(), result.path.end());
+		result.path_found = true;
+		result.path_length = state.GCost(end);
+	}
+	result.stats.peak_open = open_set.PeakSize();
+	result.stats.peak_memory = state.MemoryUsage();
+	result.duration = timer.Finish(result.stats);
+	return result;
+}
+
+SearchResult JumpPointSearch(const Grid &graph, UInt32 start, UInt32 end, SearchState &state, SearchObserver *observer)
+{
+	return DispatchSearch(graph, observer, [&](auto moves, auto report) { return JumpPointKernel(graph, start, end, moves, report, state); });
+}
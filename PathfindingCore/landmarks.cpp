@@ -0,0 +1,208 @@
+#include <random>
+#include <limits>
+#include "landmarks.h"
+
+namespace
+{
+	const float kNoDistance = std::numeric_limits<float>::infinity();
+}
+
+const UInt16 Landmarks::kUnreachable;
+
+Landmarks::Landmarks()
+	: count_(0), whole_distances_(true), reversible_(true), version_(0)
+{
+}
+
+void Landmarks::Build(const Grid &graph, UInt32 count, LandmarkSelection selection, UInt32 seed)
+{
+	std::vector<UInt32> free_cells;
+	for (UInt32 index = 0; index < graph.NodeCount(); index++)
+	{
+		if (!graph.Blocked(index))
+		{
+			free_cells.push_back(index);
+		}
+	}
+	count = std::min(count, static_cast<UInt32>(free_cells.size()));
+	std::mt19937 random(seed);
+	if (selection == RANDOM_LANDMARKS)
+	{
+		std::vector<UInt32> cells;
+		for (UInt32 i = 0; i < count; i++) // A partial shuffle, so no cell is picked twice.
+		{
+			std::swap(free_cells[i], free_cells[i + random() % (free_cells.size() - i)]);
+			cells.push_back(free_cells[i]);
+		}
+		Build(graph, cells);
+		return;
+	}
+	Begin(graph, count);
+	if (count == 0)
+	{
+		return;
+	}
+	// The first landmark is the furthest cell from a random one, then each one after is the cell furthest from all of
+	// the landmarks before it. Only cells connected to the first landmark are chosen, so the random cell has to be in
+	// a big area of the map rather than a small pocket: it is picked again until it can reach half of the free cells.
+	UInt32 next = 0, most_reached = 0;
+	for (UInt32 attempt = 0; attempt < kSeedAttempts && most_reached * 2 < free_cells.size(); attempt++)
+	{
+		UInt32 seed_cell = free_cells[random() % free_cells.size()];
+		Distances(graph, seed_cell);
+		UInt32 reached = 0, furthest = seed_cell;
+		for (UInt32 index = 0; index < graph.NodeCount(); index++)
+		{
+			if (scratch_[index] != kNoDistance)
+			{
+				reached++;
+				if (scratch_[index] > scratch_[furthest])
+				{
+					furthest = index;
+				}
+			}
+		}
+		if (reached > most_reached)
+		{
+			most_reached = reached;
+			next = furthest;
+		}
+	}
+	std::vector<float> nearest(graph.NodeCount(), kNoDistance); // Distance to the closest landmark so far.
+	for (UInt32 landmark = 0; landmark < count; landmark++)
+	{
+		cells_[landmark] = next;
+		Distances(graph, next);
+		Store(landmark);
+		float furthest_distance = 0;
+		for (UInt32 index = 0; index < graph.NodeCount(); index++)
+		{
+			nearest[index] = std::min(nearest[index], scratch_[index]);
+			if (nearest[index] != kNoDistance && nearest[index] > furthest_distance)
+			{
+				furthest_distance = nearest[index];
+				next = index;
+			}
+		}
+		if (furthest_distance == 0) // Every reachable cell is a landmark already.
+		{
+			count_ = landmark + 1;
+			break;
+		}
+	}
+	if (count_ != count) // Pack the tables down to the landmarks that were placed.
+	{
+		for (UInt32 index = 0; index < graph.NodeCount(); index++)
+		{
+			std::copy(&distances_[static_cast<size_t>(index) * count], &distances_[static_cast<size_t>(index) * count + count_], &distances_[static_cast<size_t>(index) * count_]);
+		}
+		distances_.resize(static_cast<size_t>(graph.NodeCount()) * count_);
+		cells_.resize(count_);
+		steps_.resize(count_);
+	}
+}
+
+void Landmarks::Build(const Grid &graph, const std::vector<UInt32> &cells)
+{
+	Begin(graph, static_cast<UInt32>(cells.size()));
+	for (UInt32 landmark = 0; landmark < count_; landmark++)
+	{
+		cells_[landmark] = cells[landmark];
+		Distances(graph, cells[landmark]);
+		Store(landmark);
+	}
+}
+
+void Landmarks::Begin(const Grid &graph, UInt32 count)
+{
+	count_ = count;
+	version_ = graph.Version();
+	whole_distances_ = (graph.Movement() == FOUR_CONNECTED);
+	reversible_ = whole_distances_ || (graph.CostData() == nullptr);
+	cells_.assign(count, 0);
+	steps_.assign(count, 1);
+	distances_.assign(static_cast<size_t>(graph.NodeCount()) * count, kUnreachable);
+}
+
+// Dijkstra's algorithm over the whole grid, or a breadth first search when every move costs the same.
+void Landmarks::Distances(const Grid &graph, UInt32 source)
+{
+	scratch_.assign(graph.NodeCount(), kNoDistance);
+	UInt32 neighbours[Grid::kMaxNeighbours];
+	if (graph.Blocked(source))
+	{
+		return; // No path leaves a blocked cell.
+	}
+	scratch_[source] = 0;
+	if (graph.CostData() == nullptr && graph.Movement() == FOUR_CONNECTED)
+	{
+		std::vector<UInt32> queue(1, source); // Cells come out in order of distance, so each is reached first by a shortest path.
+		for (size_t next = 0; next < queue.size(); next++)
+		{
+			float distance = scratch_[queue[next]] + 1;
+			UInt32 neighbour_count = graph.Neighbours(queue[next], neighbours);
+			for (UInt32 i = 0; i < neighbour_count; i++)
+			{
+				if (scratch_[neighbours[i]] == kNoDistance)
+				{
+					scratch_[neighbours[i]] = distance;
+					queue.push_back(neighbours[i]);
+				}
+			}
+		}
+		return;
+	}
+	open_set_.Push(source, 0);
+	while (!open_set_.Empty())
+	{
+		UInt32 current_node = open_set_.Pop();
+		UInt32 straight_count;
+		UInt32 neighbour_count = graph.Neighbours(current_node, neighbours, straight_count);
+		for (UInt32 i = 0; i < neighbour_count; i++)
+		{
+			UInt32 next_node = neighbours[i];
+			float total_distance = scratch_[current_node] + graph.MoveCost(next_node, i >= straight_count);
+			if (total_distance < scratch_[next_node]) // Distances only go down, so a cell that has been popped is never pushed again.
+			{
+				if (open_set_.Contains(next_node))
+				{
+					open_set_.DecreaseKey(next_node, total_distance);
+				}
+				else
+				{
+					open_set_.Push(next_node, total_distance);
+				}
+				scratch_[next_node] = total_distance;
+			}
+		}
+	}
+}
+
+void Landmarks::Store(UInt32 landmark)
+{
+	float longest = 0;
+	for (float distance : scratch_)
+	{
+		if (distance != kNoDistance)
+		{
+			longest = std::max(longest, distance);
+		}
+	}
+	float step = 1;
+	if (!whole_distances_)
+	{
+		step = std::max(1.0f / kFractionSteps, longest / (kUnreachable - 1));
+	}
+	else if (longest >= kUnreachable)
+	{
+		step = static_cast<float>(static_cast<UInt32>(longest) / (kUnreachable - 1) + 1); // Keeps the longest distance below kUnreachable.
+	}
+	steps_[landmark] = step;
+	for (size_t index = 0; index < scratch_.size(); index++)
+	{
+		if (scratch_[index] != kNoDistance)
+		{
+			distances_[index * count_ + landmark] = static_cast<UInt16>(std::min(scratch_[index] / step, kUnreachable - 1.0f));
+		}
+	}
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include "grid.h"
+#include "indexed_heap.h"
+
+typedef unsigned short UInt16;
+
+enum LandmarkSelection // How the landmarks are placed.
+{
+	FARTHEST_LANDMARKS, // Each landmark is the cell furthest from the ones already chosen, so they end up around the edges.
+	RANDOM_LANDMARKS // Free cells picked at random.
+};
+
+// The distance tables for the ALT heuristic (A*, Landmarks and the Triangle inequality, Goldberg and Harrelson 2005).
+// The exact distance from a few landmark cells to every cell is worked out ahead of time, and then for any landmark L
+// the triangle inequality gives d(node, end) >= d(L, end) - d(L, node). Unlike the straight line distance this knows
+// about the obstacles, so on mazes and indoor maps A* with it expands a small fraction of the nodes.
+//
+// Distances are stored as 16 bits per landmark per cell, next to each other for each cell so one node's distances share
+// a cache line. A landmark with distances longer than 65534 stores them in coarser steps, which keeps the estimate a
+// lower bound but makes it slightly inconsistent, so A* may then return a path a little longer than the shortest. The
+// same goes for 8-connected grids, where diagonal moves make the distances fractions, stored in sixteenths.
+// The tables are for the grid as it was when they were built, they must be built again after the grid changes.
+class Landmarks
+{
+public:
+	static const UInt32 kDefaultLandmarkCount = 8;
+	static const UInt16 kUnreachable = 0xFFFF;
+
+	Landmarks();
+
+	void Build(const Grid &graph, UInt32 count = kDefaultLandmarkCount, LandmarkSelection selection = FARTHEST_LANDMARKS, UInt32 seed = 1);
+	void Build(const Grid &graph, const std::vector<UInt32> &cells); // Chosen by the caller, e.g. the doors of a building.
+	bool UpToDate(const Grid &graph) const { return version_ == graph.Version(); };
+
+	// A lower bound on the distance from node to end, 0 if no landmark can reach both.
+	float LowerBound(const Grid &graph, UInt32 node, UInt32 end) const
+	{
+		const UInt16 *node_distances = &distances_[static_cast<size_t>(node) * count_];
+		const UInt16 *end_distances = &distances_[static_cast<size_t>(end) * count_];
+		int cost_difference = graph.Cost(end) - graph.Cost(node);
+		float best = 0;
+		for (UInt32 landmark = 0; landmark < count_; landmark++)
+		{
+			int to_node = node_distances[landmark], to_end = end_distances[landmark];
+			if (to_node == kUnreachable || to_end == kUnreachable)
+			{
+				continue;
+			}
+			// Going from the landmark to the end through the node can not be shorter than going straight there, and the
+			// same for going from the node to the landmark through the end. A path costs what its cells cost to move in to,
+			// so going back along it costs the cell it started from instead of the one it ends on, hence the cost terms.
+			// That only holds when every move is the same length, so on a weighted 8-connected grid only the first is used.
+			float step = steps_[landmark];
+			int slack = (step != 1 || !whole_distances_) ? 1 : 0; // Rounding down can take up to one step off either distance.
+			float through_node = (to_end - to_node - slack) * step;
+			float through_end = reversible_ ? (to_node - to_end - slack) * step + cost_difference : 0;
+			best = std::max(best, std::max(through_node, through_end));
+		}
+		return best;
+	};
+
+	UInt32 Count() const { return count_; };
+	UInt32 Landmark(UInt32 landmark) const { return cells_[landmark]; };
+	size_t MemoryUsage() const { return distances_.capacity() * sizeof(UInt16) + cells_.capacity() * sizeof(UInt32) + (steps_.capacity() + scratch_.capacity()) * sizeof(float) + open_set_.MemoryUsage(); };
+
+private:
+	static const UInt32 kSeedAttempts = 8; // Random cells tried for the search that places the first landmark.
+	static const int kFractionSteps = 16; // Steps a distance of 1 is stored in, when distances are not whole numbers.
+
+	void Begin(const Grid &graph, UInt32 count);
+	void Distances(const Grid &graph, UInt32 source); // Writes the exact distance from source to every cell in to scratch_.
+	void Store(UInt32 landmark); // Rounds scratch_ in to the table.
+
+	UInt32 count_;
+	bool whole_distances_; // Only straight moves, so every distance is a whole number.
+	bool reversible_; // The distance back along a path follows from the distance along it.
+	UInt64 version_; // Of the grid the tables were built for.
+	std::vector<UInt32> cells_;
+	std::vector<float> steps_; // By landmark, stored distances are the real distance divided by this and rounded down.
+	std::vector<UInt16> distances_; // At [cell * count_ + landmark].
+	std::vector<float> scratch_; // Exact distances from one landmark while building.
+	IndexedHeap<float> open_set_;
+};
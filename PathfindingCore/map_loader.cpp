@@ -0,0 +1,261 @@
+#include "map_loader.h"
+#include "mapped_file.h"
+#include <cstring>
+#include <cstdlib>
+#include <fstream>
+#include <utility>
+
+namespace
+{
+	// Splits mapped text into words separated by whitespace without copying it.
+	class TextReader
+	{
+	public:
+		TextReader(const MappedFile &file)
+			: position_(reinterpret_cast<const char *>(file.Data())), end_(reinterpret_cast<const char *>(file.Data()) + file.Size())
+		{
+		}
+
+		bool AtEnd()
+		{
+			SkipSpace();
+			return position_ == end_;
+		}
+
+		// Sets word to the next run of non-whitespace characters, returns false at the end of the file.
+		bool NextWord(const char *&word, size_t &length)
+		{
+			SkipSpace();
+			word = position_;
+			while (position_ != end_ && !IsSpace(*position_))
+			{
+				position_++;
+			}
+			length = position_ - word;
+			return length > 0;
+		}
+
+		bool NextWord(std::string &word)
+		{
+			const char *start;
+			size_t length;
+			if (!NextWord(start, length))
+			{
+				return false;
+			}
+			word.assign(start, length);
+			return true;
+		}
+
+		bool NextUInt(UInt32 &value)
+		{
+			const char *word;
+			size_t length;
+			if (!NextWord(word, length))
+			{
+				return false;
+			}
+			value = 0;
+			for (size_t i = 0; i < length; i++)
+			{
+				if (word[i] < '0' || word[i] > '9' || value > (0xFFFFFFFF - (word[i] - '0')) / 10) // Or too big to fit.
+				{
+					return false;
+				}
+				value = value * 10 + (word[i] - '0');
+			}
+			return true;
+		}
+
+		bool NextFloat(float &value)
+		{
+			char buffer[64]; // The mapped text is not null terminated, so the number is copied out for strtof.
+			const char *word;
+			size_t length;
+			if (!NextWord(word, length) || length >= sizeof(buffer))
+			{
+				return false;
+			}
+			std::memcpy(buffer, word, length);
+			buffer[length] = '\0';
+			char *number_end;
+			value = std::strtof(buffer, &number_end);
+			return number_end == buffer + length;
+		}
+
+	private:
+		static bool IsSpace(char character) { return character == ' ' || character == '\n' || character == '\r' || character == '\t'; };
+
+		void SkipSpace()
+		{
+			while (position_ != end_ && IsSpace(*position_))
+			{
+				position_++;
+			}
+		}
+
+		const char *position_;
+		const char *end_;
+	};
+
+	// The searches take coordinates as int and node indices are 32 bits.
+	bool ValidSize(UInt32 width, UInt32 height)
+	{
+		return width > 0 && height > 0 && width <= 0x7FFFFFFF && height <= 0x7FFFFFFF && static_cast<UInt64>(width) * height <= 0xFFFFFFFF;
+	}
+}
+
+// The header is "type octile", "height h", "width w", "map", followed by one line of characters for each row.
+bool LoadMovingAIMap(const std::string &path, Grid &graph)
+{
+	MappedFile file;
+	if (!file.Open(path))
+	{
+		return false;
+	}
+	TextReader reader(file);
+	std::string word;
+	UInt32 width = 0, height = 0;
+	while (reader.NextWord(word) && word != "map")
+	{
+		if (word == "height" && !reader.NextUInt(height))
+		{
+			return false;
+		}
+		else if (word == "width" && !reader.NextUInt(width))
+		{
+			return false;
+		}
+	}
+	if (word != "map" || !ValidSize(width, height))
+	{
+		return false;
+	}
+	graph = Grid(width, height);
+	for (UInt32 y = 0; y < height; y++)
+	{
+		const char *row;
+		size_t length;
+		if (!reader.NextWord(row, length) || length != width)
+		{
+			return false;
+		}
+		for (UInt32 x = 0; x < width; x++)
+		{
+			char cell = row[x];
+			if (!(cell == '.' || cell == 'G' || cell == 'S'))
+			{
+				graph.SetBlocked(graph.Index(x, y), true);
+			}
+		}
+	}
+	return true;
+}
+
+// After "version 1" each line is: bucket, map, map width, map height, start x, start y, goal x, goal y, optimal length.
+bool LoadMovingAIScenario(const std::string &path, std::vector<ScenarioEntry> &entries)
+{
+	MappedFile file;
+	if (!file.Open(path))
+	{
+		return false;
+	}
+	TextReader reader(file);
+	entries.clear();
+	std::string word;
+	if (!reader.NextWord(word) || word != "version" || !reader.NextWord(word))
+	{
+		return false;
+	}
+	while (!reader.AtEnd())
+	{
+		ScenarioEntry entry;
+		UInt32 map_width, map_height;
+		if (!(reader.NextUInt(entry.bucket) && reader.NextWord(entry.map_name) && reader.NextUInt(map_width) && reader.NextUInt(map_height) &&
+			reader.NextUInt(entry.start_x) && reader.NextUInt(entry.start_y) && reader.NextUInt(entry.end_x) && reader.NextUInt(entry.end_y) &&
+			reader.NextFloat(entry.optimal_length)))
+		{
+			return false;
+		}
+		entries.push_back(entry);
+	}
+	return true;
+}
+
+bool LoadGridFile(const std::string &path, Grid &graph)
+{
+	MappedFile file;
+	if (!file.Open(path) || file.Size() < sizeof(GridFileHeader))
+	{
+		return false;
+	}
+	GridFileHeader header;
+	std::memcpy(&header, file.Data(), sizeof(header));
+	if (std::memcmp(header.magic, "PGRD", 4) != 0 || header.version != kGridFileVersion || !ValidSize(header.width, header.height))
+	{
+		return false;
+	}
+	if (OccupancyBits::WordCount(header.width, header.height) > file.Size() / sizeof(UInt64) ||
+		OccupancyBits::WordCount(header.height, header.width) > file.Size() / sizeof(UInt64))
+	{
+		return false; // Keeps the byte counts below from overflowing, the file has to hold every word anyway.
+	}
+	size_t row_bytes = OccupancyBits::WordCount(header.width, header.height) * sizeof(UInt64);
+	size_t column_bytes = OccupancyBits::WordCount(header.height, header.width) * sizeof(UInt64);
+	size_t cost_bytes = (header.flags & kGridFileHasCosts) ? static_cast<size_t>(header.width) * header.height : 0;
+	if (file.Size() != sizeof(GridFileHeader) + row_bytes + column_bytes + cost_bytes)
+	{
+		return false;
+	}
+	const UInt8 *rows = file.Data() + sizeof(GridFileHeader);
+	const UInt8 *costs = (cost_bytes > 0) ? rows + row_bytes + column_bytes : nullptr;
+	if (costs != nullptr && std::memchr(costs, 0, cost_bytes) != nullptr)
+	{
+		return false; // Grid::SetCost() would not have allowed it.
+	}
+	Grid loaded(header.width, header.height, reinterpret_cast<const UInt64 *>(rows), reinterpret_cast<const UInt64 *>(rows + row_bytes), costs);
+	if (!loaded.Rows().Valid() || !loaded.Columns().Valid())
+	{
+		return false; // Stray bits in the padding would make cells outside the grid look free.
+	}
+	if (!loaded.Rows().Transposes(loaded.Columns()))
+	{
+		return false; // The searches read cells from both, so they would disagree about which cells are blocked.
+	}
+	graph = std::move(loaded);
+	return true;
+}
+
+bool SaveGridFile(const std::string &path, const Grid &graph)
+{
+	std::ofstream file(path, std::ios::binary);
+	if (!file)
+	{
+		return false;
+	}
+	GridFileHeader header;
+	std::memcpy(header.magic, "PGRD", 4);
+	header.version = kGridFileVersion;
+	header.width = graph.Width();
+	header.height = graph.Height();
+	header.flags = (graph.CostData() != nullptr) ? kGridFileHasCosts : 0;
+	header.reserved = 0;
+	file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char *>(graph.Rows().Data()), OccupancyBits::WordCount(graph.Width(), graph.Height()) * sizeof(UInt64));
+	file.write(reinterpret_cast<const char *>(graph.Columns().Data()), OccupancyBits::WordCount(graph.Height(), graph.Width()) * sizeof(UInt64));
+	if (graph.CostData() != nullptr)
+	{
+		file.write(reinterpret_cast<const char *>(graph.CostData()), graph.NodeCount());
+	}
+	return static_cast<bool>(file);
+}
+
+bool LoadMap(const std::string &path, Grid &graph)
+{
+	size_t dot = path.find_last_of('.');
+	if (dot != std::string::npos && path.compare(dot, std::string::npos, ".map") == 0)
+	{
+		return LoadMovingAIMap(path, graph);
+	}
+	return LoadGridFile(path, graph);
+}
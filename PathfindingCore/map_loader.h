@@ -0,0 +1,40 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "grid.h"
+
+// Loading of the map and scenario formats used by the MovingAI pathfinding benchmarks (movingai.com/benchmarks), and
+// of our own binary grid format. Files are memory-mapped and read in place rather than through a stream.
+// Functions return false if the file could not be read or is not in the expected format.
+
+// One line of a .scen file, the coordinates are in the map the line names.
+struct ScenarioEntry
+{
+	UInt32 bucket;
+	std::string map_name;
+	UInt32 start_x, start_y;
+	UInt32 end_x, end_y;
+	float optimal_length; // 8-connected without corner cutting.
+};
+
+// A .grid file is this header followed by the grid's occupancy bits by row and by column (OccupancyBits::Data(),
+// padding included) and then, if the grid has costs, one cost byte per cell in index order, none of them 0. That is
+// the layout Grid keeps in memory, so loading one is a few block copies out of the mapped file with nothing to parse,
+// then a check, 64 by 64 cells at a time, that the columns hold the same cells as the rows. The grid is copied rather
+// than read from the mapping, as it can be edited once it is loaded. Numbers are stored little-endian.
+struct GridFileHeader
+{
+	char magic[4]; // "PGRD"
+	UInt32 version;
+	UInt32 width, height;
+	UInt32 flags;
+	UInt32 reserved; // Keeps the words that follow 8-byte aligned in the mapping.
+};
+const UInt32 kGridFileVersion = 2;
+const UInt32 kGridFileHasCosts = 1;
+
+bool LoadMovingAIMap(const std::string &path, Grid &graph); // '.', 'G' and 'S' are free, everything else is blocked.
+bool LoadMovingAIScenario(const std::string &path, std::vector<ScenarioEntry> &entries);
+bool LoadGridFile(const std::string &path, Grid &graph);
+bool SaveGridFile(const std::string &path, const Grid &graph);
+bool LoadMap(const std::string &path, Grid &graph); // Picks the format from the extension, .map files are MovingAI maps and anything else is a .grid file.
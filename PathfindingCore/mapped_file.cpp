@@ -0,0 +1,116 @@
+#include "mapped_file.h"
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+MappedFile::MappedFile()
+	: data_(nullptr), size_(0), file_(INVALID_HANDLE_VALUE), mapping_(nullptr)
+{
+}
+#else
+MappedFile::MappedFile()
+	: data_(nullptr), size_(0)
+{
+}
+#endif
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+#ifdef _WIN32
+bool MappedFile::Open(const std::string &path)
+{
+	Close();
+	file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file_ == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(file_, &file_size) || file_size.QuadPart == 0)
+	{
+		Close();
+		return false;
+	}
+	mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping_ == nullptr)
+	{
+		Close();
+		return false;
+	}
+	data_ = static_cast<const UInt8 *>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+	if (data_ == nullptr)
+	{
+		Close();
+		return false;
+	}
+	size_ = static_cast<size_t>(file_size.QuadPart);
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (data_ != nullptr)
+	{
+		UnmapViewOfFile(data_);
+	}
+	if (mapping_ != nullptr)
+	{
+		CloseHandle(mapping_);
+	}
+	if (file_ != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(file_);
+	}
+	data_ = nullptr;
+	size_ = 0;
+	mapping_ = nullptr;
+	file_ = INVALID_HANDLE_VALUE;
+}
+#else
+bool MappedFile::Open(const std::string &path)
+{
+	Close();
+	int file = open(path.c_str(), O_RDONLY);
+	if (file < 0)
+	{
+		return false;
+	}
+	struct stat file_status;
+	if (fstat(file, &file_status) != 0 || file_status.st_size == 0)
+	{
+		close(file);
+		return false;
+	}
+	void *data = mmap(nullptr, static_cast<size_t>(file_status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+	close(file); // The mapping keeps the file open.
+	if (data == MAP_FAILED)
+	{
+		return false;
+	}
+	madvise(data, static_cast<size_t>(file_status.st_size), MADV_SEQUENTIAL); // Maps are read from start to end.
+	data_ = static_cast<const UInt8 *>(data);
+	size_ = static_cast<size_t>(file_status.st_size);
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (data_ != nullptr)
+	{
+		munmap(const_cast<UInt8 *>(data_), size_);
+	}
+	data_ = nullptr;
+	size_ = 0;
+}
+#endif
@@ -0,0 +1,30 @@
+#pragma once
+#include <string>
+#include <cstddef>
+#include "grid.h"
+
+// A read-only view of a whole file through the virtual memory system. Pages are only read from disk when they are
+// touched, so opening a large map costs nothing until it is used and nothing is copied through a stream buffer.
+class MappedFile
+{
+public:
+	MappedFile();
+	~MappedFile();
+
+	bool Open(const std::string &path); // Returns false if the file can not be opened or mapped, empty files can not be mapped.
+	void Close();
+	bool IsOpen() const { return data_ != nullptr; };
+	const UInt8 *Data() const { return data_; };
+	size_t Size() const { return size_; };
+
+private:
+	MappedFile(const MappedFile &);
+	MappedFile &operator=(const MappedFile &);
+
+	const UInt8 *data_;
+	size_t size_;
+#ifdef _WIN32
+	void *file_; // HANDLE, kept as void * so that windows.h is not needed here.
+	void *mapping_;
+#endif
+};
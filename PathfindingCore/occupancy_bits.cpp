@@ -0,0 +1,96 @@
+#include "occupancy_bits.h"
+
+OccupancyBits::OccupancyBits()
+	: width_(0), height_(0), stride_(Stride(0)), words_(WordCount(0, 0), 0)
+{
+}
+
+OccupancyBits::OccupancyBits(UInt32 width, UInt32 height)
+	: width_(width), height_(height), stride_(Stride(width)), words_(WordCount(width, height), 0)
+{
+	for (UInt32 y = 0; y < height; y++)
+	{
+		for (UInt32 word = 0; word < width / 64; word++)
+		{
+			words_[RowStart(y) + 1 + word] = ~0ULL;
+		}
+		if (width % 64 != 0)
+		{
+			words_[RowStart(y) + 1 + width / 64] = (1ULL << (width % 64)) - 1;
+		}
+	}
+}
+
+OccupancyBits::OccupancyBits(UInt32 width, UInt32 height, const UInt64 *words)
+	: width_(width), height_(height), stride_(Stride(width)), words_(words, words + WordCount(width, height))
+{
+}
+
+bool OccupancyBits::Valid() const
+{
+	UInt64 last_word_mask = (width_ % 64 == 0) ? ~0ULL : (1ULL << (width_ % 64)) - 1;
+	for (size_t row_index = 0; row_index <= static_cast<size_t>(height_) + 1; row_index++) // Counts the padding rows too, so row y is y + 1.
+	{
+		const UInt64 *row = &words_[row_index * stride_];
+		if (row_index == 0 || row_index == static_cast<size_t>(height_) + 1)
+		{
+			for (size_t word = 0; word < stride_; word++)
+			{
+				if (row[word] != 0)
+				{
+					return false;
+				}
+			}
+		}
+		else if (row[0] != 0 || row[stride_ - 1] != 0 || (width_ > 0 && (row[stride_ - 2] & ~last_word_mask) != 0))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool OccupancyBits::Transposes(const OccupancyBits &other) const
+{
+	if (other.width_ != height_ || other.height_ != width_)
+	{
+		return false;
+	}
+	// A block of 64 by 64 cells at a time: the block's rows are transposed in place, and then they are its columns.
+	UInt64 block[64];
+	for (UInt32 y = 0; y < height_; y += 64)
+	{
+		for (UInt32 x = 0; x < width_; x += 64)
+		{
+			for (UInt32 i = 0; i < 64; i++)
+			{
+				block[i] = (y + i < height_) ? Run(static_cast<int>(x), static_cast<int>(y + i)) : 0; // The padding past the width reads as zeros.
+			}
+			Transpose(block);
+			for (UInt32 i = 0; i < 64 && x + i < width_; i++)
+			{
+				if (other.Run(static_cast<int>(y), static_cast<int>(x + i)) != block[i])
+				{
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+void OccupancyBits::Transpose(UInt64 block[64])
+{
+	// Swaps the top right and bottom left quarters of every square of 2 * half bits, from squares of 64 down to squares
+	// of 2. mask picks out the left half of each square's rows.
+	UInt64 mask = 0x00000000FFFFFFFFULL;
+	for (int half = 32; half != 0; half >>= 1, mask ^= mask << half)
+	{
+		for (int row = 0; row < 64; row = ((row | half) + 1) & ~half) // The rows in the top half of a square.
+		{
+			UInt64 swapped = ((block[row] >> half) ^ block[row | half]) & mask;
+			block[row] ^= swapped << half;
+			block[row | half] ^= swapped;
+		}
+	}
+}
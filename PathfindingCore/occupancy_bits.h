@@ -0,0 +1,108 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+typedef unsigned int UInt32;
+typedef unsigned long long UInt64;
+
+// One bit per cell, set if the cell is free, packed into 64-bit words along each row. Rows start on a word boundary and
+// are surrounded by a word of zeros on either side and a row of zeros above and below, so a run of 64 cells can be
+// read starting anywhere from 64 cells before a row to the end of it, and the cells outside the grid read as blocked.
+// The bits past the width in the last word of a row are kept at zero for the same reason.
+class OccupancyBits
+{
+public:
+	OccupancyBits();
+	OccupancyBits(UInt32 width, UInt32 height); // Every cell starts free.
+	OccupancyBits(UInt32 width, UInt32 height, const UInt64 *words); // Copies WordCount(width, height) words laid out as Data() is.
+
+	static size_t WordCount(UInt32 width, UInt32 height) { return Stride(width) * (static_cast<size_t>(height) + 2); };
+
+	bool Free(int x, int y) const { return ((words_[RowStart(y) + ((x + 64) >> 6)] >> ((x + 64) & 63)) & 1) != 0; }; // -64 <= x, -1 <= y <= height.
+	void SetFree(UInt32 x, UInt32 y, bool free)
+	{
+		UInt64 &word = words_[RowStart(y) + 1 + (x >> 6)];
+		UInt64 bit = 1ULL << (x & 63);
+		word = free ? (word | bit) : (word & ~bit);
+	}
+
+	// The cells x to x + 63 of row y, cell x + i in bit i. Takes -64 <= x <= width and -1 <= y <= height.
+	UInt64 Run(int x, int y) const
+	{
+		size_t position = RowStart(y) + ((x + 64) >> 6);
+		int shift = (x + 64) & 63;
+		if (shift == 0)
+		{
+			return words_[position];
+		}
+		return (words_[position] >> shift) | (words_[position + 1] << (64 - shift)); // The next word is at worst the next row's zero word.
+	}
+
+	// The four cells around (x, y) as bits 0 to 3: above, left, right and below. Takes 0 <= x < width and 0 <= y < height.
+	UInt32 Around(int x, int y) const
+	{
+		size_t position = RowStart(y) + 1 + (x >> 6);
+		int shift = x & 63;
+		UInt64 word = words_[position];
+		UInt64 left = (shift == 0) ? (words_[position - 1] >> 63) : (word >> (shift - 1));
+		UInt64 right = (shift == 63) ? words_[position + 1] : (word >> (shift + 1));
+		return static_cast<UInt32>(((words_[position - stride_] >> shift) & 1) | ((left & 1) << 1) | ((right & 1) << 2) | (((words_[position + stride_] >> shift) & 1) << 3));
+	}
+
+	bool Valid() const; // Checks that the padding is all zeros, for data that was loaded from a file.
+	// True if other holds the same cells with x and y swapped, as a grid's columns do its rows. Both must be Valid().
+	bool Transposes(const OccupancyBits &other) const;
+	static void Transpose(UInt64 block[64]); // Swaps x and y in a block of 64 by 64 cells, cell x of row y is bit x of block[y].
+	const UInt64 *Data() const { return words_.data(); };
+	size_t MemoryUsage() const { return words_.capacity() * sizeof(UInt64); };
+
+	// Index of the lowest/highest set bit, word must not be 0. These compile to a single bit scan instruction.
+	static int LowestBit(UInt64 word)
+	{
+#if defined(_MSC_VER) && defined(_M_X64)
+		unsigned long index;
+		_BitScanForward64(&index, word);
+		return static_cast<int>(index);
+#elif defined(_MSC_VER)
+		unsigned long index;
+		if (_BitScanForward(&index, static_cast<unsigned long>(word)))
+		{
+			return static_cast<int>(index);
+		}
+		_BitScanForward(&index, static_cast<unsigned long>(word >> 32));
+		return static_cast<int>(index) + 32;
+#else
+		return __builtin_ctzll(word);
+#endif
+	}
+
+	static int HighestBit(UInt64 word)
+	{
+#if defined(_MSC_VER) && defined(_M_X64)
+		unsigned long index;
+		_BitScanReverse64(&index, word);
+		return static_cast<int>(index);
+#elif defined(_MSC_VER)
+		unsigned long index;
+		if (_BitScanReverse(&index, static_cast<unsigned long>(word >> 32)))
+		{
+			return static_cast<int>(index) + 32;
+		}
+		_BitScanReverse(&index, static_cast<unsigned long>(word));
+		return static_cast<int>(index);
+#else
+		return 63 - __builtin_clzll(word);
+#endif
+	}
+
+private:
+	static size_t Stride(UInt32 width) { return (static_cast<size_t>(width) + 63) / 64 + 2; }; // Words per row, including the zero word at each end.
+	size_t RowStart(int y) const { return static_cast<size_t>(y + 1) * stride_; };
+
+	UInt32 width_, height_;
+	size_t stride_;
+	std::vector<UInt64> words_;
+};
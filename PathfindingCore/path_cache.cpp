@@ -0,0 +1,174 @@
+#include <chrono>
+#include <algorithm>
+#include "path_cache.h"
+using namespace std;
+
+namespace
+{
+	// Passes the search's progress on, while keeping the bounding rectangle of the nodes it opens and closes.
+	class RegionObserver : public SearchObserver
+	{
+	public:
+		RegionObserver(const Grid &graph, SearchObserver *observer)
+			: min_x(graph.Width()), min_y(graph.Height()), max_x(0), max_y(0), graph_(graph), observer_(observer) {};
+
+		void Add(UInt32 node)
+		{
+			UInt32 x = graph_.X(node), y = graph_.Y(node);
+			min_x = min(min_x, x);
+			min_y = min(min_y, y);
+			max_x = max(max_x, x);
+			max_y = max(max_y, y);
+		}
+
+		void NodeOpened(UInt32 node)
+		{
+			Add(node);
+			if (observer_ != nullptr)
+			{
+				observer_->NodeOpened(node);
+			}
+		}
+
+		void NodeClosed(UInt32 node)
+		{
+			Add(node);
+			if (observer_ != nullptr)
+			{
+				observer_->NodeClosed(node);
+			}
+		}
+
+		void NodeRelaxed(UInt32 node)
+		{
+			if (observer_ != nullptr)
+			{
+				observer_->NodeRelaxed(node);
+			}
+		}
+
+		bool Cancelled() const
+		{
+			return observer_ != nullptr && observer_->Cancelled();
+		}
+
+		UInt32 min_x, min_y, max_x, max_y;
+
+	private:
+		const Grid &graph_;
+		SearchObserver *observer_;
+	};
+}
+
+PathCache::PathCache(size_t memory_limit)
+	: memory_limit_(memory_limit), memory_used_(0), version_(0), hits_(0), misses_(0), invalidations_(0), evictions_(0)
+{
+}
+
+SearchResult PathCache::FindPath(const Grid &graph, UInt32 start, UInt32 end, Algorithm algorithm, SearchState &state, SearchObserver *observer)
+{
+	auto start_time = chrono::steady_clock::now();
+	if (graph.Version() != version_) // Changed without being told, or a different grid.
+	{
+		invalidations_ += lookup_.size();
+		Clear();
+		version_ = graph.Version();
+	}
+	Key key = { start, end, algorithm };
+	auto found = lookup_.find(key);
+	if (found != lookup_.end())
+	{
+		hits_++;
+		entries_.splice(entries_.begin(), entries_, found->second); // Now the most recently used.
+		SearchResult result = found->second->result;
+		result.nodes_expanded = 0;
+		result.stats = SearchStats(); // Nothing was searched.
+		result.duration = chrono::duration<float>(chrono::steady_clock::now() - start_time).count();
+		result.stats.search_time = result.duration;
+		return result;
+	}
+	misses_++;
+	RegionObserver region(graph, observer);
+	region.Add(start);
+	region.Add(end);
+	SearchResult result = ::FindPath(graph, start, end, algorithm, state, &region);
+	if (region.Cancelled())
+	{
+		return result; // Stopped part way, so it is not the answer.
+	}
+
+	Entry entry;
+	entry.key = key;
+	entry.result = result;
+	if (algorithm == JUMP_POINT_SEARCH || algorithm == HIERARCHICAL_A_STAR || algorithm == A_STAR_LANDMARKS)
+	{
+		entry.min_x = 0;
+		entry.min_y = 0;
+		entry.max_x = graph.Width() - 1;
+		entry.max_y = graph.Height() - 1;
+	}
+	else // One cell further out, a blocked cell next to the explored area is never opened but could open up a shorter path.
+	{
+		entry.min_x = (region.min_x > 0) ? region.min_x - 1 : 0;
+		entry.min_y = (region.min_y > 0) ? region.min_y - 1 : 0;
+		entry.max_x = min(region.max_x + 1, graph.Width() - 1);
+		entry.max_y = min(region.max_y + 1, graph.Height() - 1);
+	}
+	size_t size = EntrySize(entry);
+	if (size > memory_limit_)
+	{
+		return result; // Would push everything else out.
+	}
+	while (memory_used_ + size > memory_limit_)
+	{
+		evictions_++;
+		Erase(prev(entries_.end()));
+	}
+	entries_.push_front(std::move(entry));
+	lookup_[key] = entries_.begin();
+	memory_used_ += size;
+	return result;
+}
+
+void PathCache::CellChanged(const Grid &graph, UInt32 index, UInt64 previous_version)
+{
+	if (previous_version != version_) // The grid had already changed some other way, so the rectangles say nothing.
+	{
+		invalidations_ += lookup_.size();
+		Clear();
+		version_ = graph.Version();
+		return;
+	}
+	UInt32 x = graph.X(index), y = graph.Y(index);
+	for (EntryIterator entry = entries_.begin(); entry != entries_.end(); )
+	{
+		EntryIterator next = std::next(entry);
+		if (x >= entry->min_x && x <= entry->max_x && y >= entry->min_y && y <= entry->max_y)
+		{
+			invalidations_++;
+			Erase(entry);
+		}
+		entry = next;
+	}
+	version_ = graph.Version(); // Everything left is still right for the grid as it is now.
+}
+
+void PathCache::Clear()
+{
+	entries_.clear();
+	lookup_.clear();
+	memory_used_ = 0;
+}
+
+size_t PathCache::EntrySize(const Entry &entry)
+{
+	// The list node, and roughly what the hash table spends on each entry.
+	return sizeof(Entry) + 2 * sizeof(void *) + sizeof(Key) + sizeof(EntryIterator) + 2 * sizeof(void *) + entry.result.path.capacity() * sizeof(UInt32);
+}
+
+void PathCache::Erase(EntryIterator entry)
+{
+	memory_used_ -= EntrySize(*entry);
+	lookup_.erase(entry->key);
+	entries_.erase(entry);
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include "pathfinding.h"
+
+// Remembers the results of searches, so asking for the same path again before the grid changes costs a hash lookup.
+//
+// Each result is kept with the rectangle of cells its search looked at: every node it opened or closed, and the cells
+// around them. Changing a cell outside that rectangle cannot change the result, because any better path would have to
+// leave the explored area through a cell the search has already weighed up. So when a cell changes, only the results
+// whose rectangle holds it are forgotten. Jump point search and HPA* read cells that they never open, and A* (Landmarks)
+// estimates with distances measured over the whole grid, so their results are forgotten on any change.
+//
+// The cache has to be told about every change to the grid through CellChanged(). If it finds the grid at a version it
+// was not told about it forgets everything, which also keeps it from answering for a different grid. CellChanged() checks
+// the version from before the edit for the same reason, so an edit can not pass over a change it was not told about.
+// Not safe to use from more than one thread at a time.
+class PathCache
+{
+public:
+	static const size_t kDefaultMemoryLimit = 16 * 1024 * 1024; // Bytes, the least recently used results are dropped to stay under it.
+
+	explicit PathCache(size_t memory_limit = kDefaultMemoryLimit);
+
+	// Returns the remembered result, or runs the search and remembers it. A remembered result is returned without calling
+	// the observer, with nodes_expanded and the stats set to 0 and duration set to the time taken to find it. A search the
+	// observer cancelled is not remembered.
+	SearchResult FindPath(const Grid &graph, UInt32 start, UInt32 end, Algorithm algorithm, SearchState &state, SearchObserver *observer = nullptr);
+	// After the cell has been blocked, unblocked or had its cost changed, previous_version is graph.Version() from before.
+	void CellChanged(const Grid &graph, UInt32 index, UInt64 previous_version);
+	void Clear();
+
+	UInt64 Hits() const { return hits_; };
+	UInt64 Misses() const { return misses_; };
+	UInt64 Invalidations() const { return invalidations_; }; // Results forgotten because a cell they depend on changed.
+	UInt64 Evictions() const { return evictions_; }; // Results dropped to stay under the memory limit.
+	size_t EntryCount() const { return lookup_.size(); };
+	size_t MemoryUsage() const { return memory_used_; };
+
+private:
+	struct Key
+	{
+		UInt32 start, end;
+		Algorithm algorithm;
+		bool operator==(const Key &other) const { return start == other.start && end == other.end && algorithm == other.algorithm; };
+	};
+
+	struct KeyHash
+	{
+		size_t operator()(const Key &key) const { return (static_cast<size_t>(key.start) * 0x9E3779B1u) ^ (static_cast<size_t>(key.end) << 3) ^ key.algorithm; };
+	};
+
+	struct Entry
+	{
+		Key key;
+		SearchResult result;
+		UInt32 min_x, min_y, max_x, max_y; // The cells the search depended on, inclusive.
+	};
+
+	typedef std::list<Entry>::iterator EntryIterator;
+
+	static size_t EntrySize(const Entry &entry);
+	void Erase(EntryIterator entry);
+
+	size_t memory_limit_;
+	size_t memory_used_;
+	UInt64 version_; // Of the grid the results are for.
+	std::list<Entry> entries_; // Most recently used first.
+	std::unordered_map<Key, EntryIterator, KeyHash> lookup_;
+	UInt64 hits_, misses_, invalidations_, evictions_;
+};
@@ -0,0 +1,368 @@
+#include <iostream>
+#include <cmath>
+#include <algorithm>
+#include <vector>
+#include "pathfinding.h"
+#include "search_state.h"
+#include "search_policies.h"
+#include "hierarchical_search.h"
+#include "d_star_lite.h"
+using namespace std;
+
+const char *AlgorithmName(Algorithm algorithm)
+{
+	switch (algorithm)
+	{
+	case A_STAR_DIAGONAL:
+		return "A* (Diagonal)";
+	case A_STAR_MANHATTAN:
+		return "A* (Manhatten)";
+	case DIJKSTRA:
+		return "Dijkstras algorithm";
+	case JUMP_POINT_SEARCH:
+		return "Jump point search";
+	case BIDIRECTIONAL_DIJKSTRA:
+		return "Bidirectional Dijkstra";
+	case BIDIRECTIONAL_A_STAR:
+		return "Bidirectional A*";
+	case HIERARCHICAL_A_STAR:
+		return "Hierarchical A* (HPA*)";
+	case D_STAR_LITE:
+		return "D* Lite (replanning)";
+	case A_STAR_LANDMARKS:
+		return "A* (Landmarks)";
+	case DIAL_DIJKSTRA:
+		return "Dials algorithm (Buckets)";
+	case DIAL_A_STAR:
+		return "A* (Manhatten) Buckets";
+	default:
+		return "Unknown";
+	}
+}
+
+Algorithm SearchedAlgorithm(const Grid &graph, Algorithm algorithm)
+{
+	if (algorithm == JUMP_POINT_SEARCH)
+	{
+		if (graph.Movement() == EIGHT_CONNECTED && graph.CornerRule() != NO_CORNER_CUTTING)
+		{
+			return A_STAR_DIAGONAL; // The pruning rules only hold when diagonal moves never cut corners.
+		}
+		if (graph.CostData() != nullptr)
+		{
+			return (graph.Movement() == FOUR_CONNECTED) ? A_STAR_MANHATTAN : A_STAR_DIAGONAL; // Jumping assumes every cell costs 1.
+		}
+	}
+	if (graph.Movement() == EIGHT_CONNECTED) // As BucketSearch() does.
+	{
+		if (algorithm == DIAL_DIJKSTRA)
+		{
+			return DIJKSTRA;
+		}
+		if (algorithm == DIAL_A_STAR)
+		{
+			return A_STAR_DIAGONAL;
+		}
+	}
+	return algorithm;
+}
+
+SearchResult FindPath(const Grid &graph, UInt32 start, UInt32 end, Algorithm algorithm, SearchState &state, SearchObserver *observer)
+{
+	Algorithm searched = SearchedAlgorithm(graph, algorithm);
+	if (searched != algorithm)
+	{
+		return FindPath(graph, start, end, searched, state, observer);
+	}
+	if (algorithm == DIJKSTRA)
+	{
+		return DijkstrasAlgorithm(graph, start, end, state, observer);
+	}
+	if (algorithm == JUMP_POINT_SEARCH)
+	{
+		return JumpPointSearch(graph, start, end, state, observer);
+	}
+	if (algorithm == BIDIRECTIONAL_DIJKSTRA)
+	{
+		return BidirectionalSearch(graph, start, end, DIJKSTRA, state, observer);
+	}
+	if (algorithm == BIDIRECTIONAL_A_STAR)
+	{
+		// Manhattan distance is the closer estimate on a 4-connected grid, but too high once diagonal moves are allowed.
+		return BidirectionalSearch(graph, start, end, (graph.Movement() == FOUR_CONNECTED) ? A_STAR_MANHATTAN : A_STAR_DIAGONAL, state, observer);
+	}
+	if (algorithm == HIERARCHICAL_A_STAR)
+	{
+		HierarchicalPathfinder hierarchy;
+		return hierarchy.FindPath(graph, start, end, state, observer);
+	}
+	if (algorithm == D_STAR_LITE)
+	{
+		DStarLite replanner;
+		return replanner.FindPath(graph, start, end, observer);
+	}
+	if (algorithm == DIAL_DIJKSTRA)
+	{
+		return BucketSearch(graph, start, end, DIJKSTRA, state, observer);
+	}
+	if (algorithm == DIAL_A_STAR)
+	{
+		return BucketSearch(graph, start, end, A_STAR_MANHATTAN, state, observer);
+	}
+	if (algorithm == A_STAR_LANDMARKS)
+	{
+		Landmarks landmarks;
+		landmarks.Build(graph);
+		return LandmarkAStar(graph, start, end, landmarks, state, observer);
+	}
+	return AStarAlgorithm(graph, start, end, algorithm, state, observer);
+}
+
+SearchResult FindPath(const Grid &graph, UInt32 start, UInt32 end, Algorithm algorithm, SearchObserver *observer)
+{
+	SearchState state;
+	return FindPath(graph, start, end, algorithm, state, observer);
+}
+
+// Walks back through the parents from the end node, this fills in the path of the result.
+static void TracePath(const SearchState &state, UInt32 start, UInt32 end, SearchResult &result)
+{
+	UInt32 path_node = end; // Current node being added to the path.
+	while (path_node != start)
+	{
+		result.path.push_back(path_node); // Add to path.
+		path_node = state.Parent(path_node); // Next node to add.
+	}
+	result.path.push_back(start);
+	std::reverse(result.path.begin(), result.path.end()); // Built from the end, so it needs to be flipped to start from the start node.
+	result.path_found = true;
+	result.path_length = state.GCost(end); // Path length is the final length to the end node.
+}
+
+// One best-first search loop for Dijkstra and every A*, Dijkstra being the one with no estimate. The estimate, moves and
+// report are template parameters, so each combination of them is compiled as a loop of its own with nothing left to
+// decide per node, and the choice is made once per query by DispatchSearch().
+template <typename Estimate, typename Connected, typename Report>
+static SearchResult SearchKernel(const Grid &graph, UInt32 start, UInt32 end, const Estimate &estimate, Connected, Report report, SearchState &state)
+{
+	SearchTimer timer; // Used to measure the time that the algorithm has been running.
+	SearchResult result;
+	if (graph.Blocked(start) || graph.Blocked(end))
+	{
+		result.duration = timer.Finish(result.stats);
+		return result; // No path leads out of or in to a blocked cell, not even the empty one when start == end.
+	}
+	state.Begin(graph.NodeCount()); // Forgets the previous search without clearing anything.
+	IndexedHeap<OpenSetKey> &open_set = state.OpenSet(); // Ordered from lowest distance/f-cost.
+
+	float current_distance = 0; // Distance to start node is 0.
+	UInt32 current_node;
+	UInt32 neighbours[Grid::kMaxNeighbours];
+	bool no_path = false;
+
+	float h_cost = estimate(start, end);
+	state.Open(start, current_distance, h_cost, SearchState::kNoParent); // Start node has no parent
+	result.stats.nodes_generated++;
+	report.Opened(start);
+	while (no_path == false)
+	{
+		current_node = open_set.Top(); // This gives the node with the lowest f-cost as the heap is ordered by distance/f-cost.
+		current_distance = state.GCost(current_node);
+		if (current_node == end)
+		{
+			break; // We have found a path.
+		}
+		open_set.Pop();
+		state.Close(current_node); // Mark current node as visited/add it to the closed set.
+		result.nodes_expanded++;
+		UInt32 straight_count;
+		UInt32 neighbour_count = graph.Moves<Connected::value>(current_node, neighbours, straight_count); // Blocked cells are left out.
+		for (UInt32 i = 0; i < neighbour_count; i++)
+		{
+			UInt32 next_node = neighbours[i];
+			if (state.Closed(next_node)) // If this node has already been added to the closed set:
+			{
+				continue; // Move on to the next node.
+			}
+			float total_distance = current_distance + graph.MoveCost(next_node, i >= straight_count); // Calculate total distance to this node through the current_node.
+			if (!state.InOpenSet(next_node)) // If the node is NOT already in the open set.
+			{
+				// Estimated distance to end node from this node, for dijkstras algorithm this is 0 so f_cost = g_cost.
+				h_cost = estimate(next_node, end);
+				state.Open(next_node, total_distance, h_cost, current_node);
+				result.stats.nodes_generated++;
+				report.Opened(next_node);
+			}
+			else if (total_distance < state.GCost(next_node)) // If this node IS in the open set and this path gives a shorter distance:
+			{
+				state.Relax(next_node, total_distance, current_node); // Recalculates the f-cost and moves it up the heap.
+				result.stats.decrease_keys++;
+				report.Relaxed(next_node);
+			}
+		}
+		report.Closed(current_node);
+		if (open_set.Empty() || report.Cancelled())
+		{
+			no_path = true;
+		}
+	}
+	// Trace path.
+	if (no_path == false)
+	{
+		timer.PathStarted();
+		TracePath(state, start, end, result);
+	}
+	result.stats.peak_open = open_set.PeakSize();
+	result.stats.peak_memory = state.MemoryUsage();
+	result.duration = timer.Finish(result.stats);
+	return result;
+}
+
+template <typename Estimate>
+static SearchResult BestFirstSearch(const Grid &graph, UInt32 start, UInt32 end, const Estimate &estimate, SearchState &state, SearchObserver *observer)
+{
+	return DispatchSearch(graph, observer, [&](auto moves, auto report) { return SearchKernel(graph, start, end, estimate, moves, report, state); });
+}
+
+SearchResult DijkstrasAlgorithm(const Grid &graph, UInt32 start, UInt32 end, SearchState &state, SearchObserver *observer)
+{
+	return BestFirstSearch(graph, start, end, NoEstimate(), state, observer);
+}
+
+SearchResult AStarAlgorithm(const Grid &graph, UInt32 start, UInt32 end, Algorithm heuristic, SearchState &state, SearchObserver *observer)
+{
+	if (heuristic == A_STAR_MANHATTAN) // This is to determine what heuristic to use.
+	{
+		return BestFirstSearch(graph, start, end, ManhattanEstimate(graph), state, observer);
+	}
+	return BestFirstSearch(graph, start, end, DiagonalEstimate(graph), state, observer);
+}
+
+SearchResult LandmarkAStar(const Grid &graph, UInt32 start, UInt32 end, const Landmarks &landmarks, SearchState &state, SearchObserver *observer)
+{
+	if (graph.Movement() == FOUR_CONNECTED)
+	{
+		return BestFirstSearch(graph, start, end, LandmarkEstimate<ManhattanEstimate>(graph, landmarks), state, observer);
+	}
+	return BestFirstSearch(graph, start, end, LandmarkEstimate<DiagonalEstimate>(graph, landmarks), state, observer);
+}
+
+// Dial's algorithm, the bucket queue version of SearchKernel(). Only ever 4-connected, so only the estimate and report vary.
+template <typename Estimate, typename Report>
+static SearchResult BucketKernel(const Grid &graph, UInt32 start, UInt32 end, const Estimate &estimate, Report report, SearchState &state)
+{
+	SearchTimer timer; // Used to measure the time that the algorithm has been running.
+	SearchResult result;
+	if (graph.Blocked(start) || graph.Blocked(end))
+	{
+		result.duration = timer.Finish(result.stats);
+		return result; // As for SearchKernel().
+	}
+	state.Begin(graph.NodeCount()); // Forgets the previous search without clearing anything.
+	BucketQueue &open_set = state.Buckets(); // Ordered from lowest distance/f-cost, a bucket for each.
+	UInt32 neighbours[Grid::kMaxNeighbours];
+	bool path_found = false;
+
+	float h_cost = estimate(start, end);
+	// A move costs at most 255, and changes the Manhattan distance by 1, so that is as far as a key can go past the last one popped.
+	open_set.Begin(static_cast<unsigned int>(h_cost), (graph.CostData() == nullptr) ? 2 : 256);
+	state.Reach(start, 0, h_cost, SearchState::kNoParent); // Start node has no parent
+	open_set.Push(start, static_cast<unsigned int>(h_cost));
+	result.stats.nodes_generated++;
+	report.Opened(start);
+	while (!open_set.Empty())
+	{
+		UInt32 current_node = open_set.Pop();
+		if (state.Closed(current_node))
+		{
+			continue; // An old copy, the node was pushed again when a shorter route to it was found.
+		}
+		if (current_node == end)
+		{
+			path_found = true; // We have found a path.
+			break;
+		}
+		state.Close(current_node);
+		result.nodes_expanded++;
+		float current_distance = state.GCost(current_node);
+		UInt32 straight_count;
+		UInt32 neighbour_count = graph.Moves<FOUR_CONNECTED>(current_node, neighbours, straight_count); // Blocked cells are left out.
+		for (UInt32 i = 0; i < neighbour_count; i++)
+		{
+			UInt32 next_node = neighbours[i];
+			if (state.Closed(next_node))
+			{
+				continue;
+			}
+			float total_distance = current_distance + graph.Cost(next_node);
+			if (!state.InOpenSet(next_node))
+			{
+				h_cost = estimate(next_node, end);
+				state.Reach(next_node, total_distance, h_cost, current_node);
+				open_set.Push(next_node, static_cast<unsigned int>(total_distance + h_cost));
+				result.stats.nodes_generated++;
+				report.Opened(next_node);
+			}
+			else if (total_distance < state.GCost(next_node)) // A shorter route, the copy with the old key is left in its bucket.
+			{
+				state.Reach(next_node, total_distance, state.HCost(next_node), current_node);
+				open_set.Push(next_node, static_cast<unsigned int>(total_distance + state.HCost(next_node)));
+				result.stats.decrease_keys++;
+				report.Relaxed(next_node);
+			}
+		}
+		report.Closed(current_node);
+		if (report.Cancelled())
+		{
+			break;
+		}
+	}
+	if (path_found)
+	{
+		timer.PathStarted();
+		TracePath(state, start, end, result);
+	}
+	result.stats.peak_open = open_set.PeakSize();
+	result.stats.peak_memory = state.MemoryUsage();
+	result.duration = timer.Finish(result.stats);
+	return result;
+}
+
+template <typename Estimate>
+static SearchResult DialSearch(const Grid &graph, UInt32 start, UInt32 end, const Estimate &estimate, SearchState &state, SearchObserver *observer)
+{
+	return DispatchSearch(graph, observer, [&](auto, auto report) { return BucketKernel(graph, start, end, estimate, report, state); });
+}
+
+SearchResult BucketSearch(const Grid &graph, UInt32 start, UInt32 end, Algorithm heuristic, SearchState &state, SearchObserver *observer)
+{
+	if (graph.Movement() == EIGHT_CONNECTED) // Diagonal moves cost a multiple of root 2, which is not a whole number.
+	{
+		return (heuristic == DIJKSTRA) ? DijkstrasAlgorithm(graph, start, end, state, observer) : AStarAlgorithm(graph, start, end, A_STAR_DIAGONAL, state, observer);
+	}
+	if (heuristic == A_STAR_MANHATTAN)
+	{
+		return DialSearch(graph, start, end, ManhattanEstimate(graph), state, observer);
+	}
+	return DialSearch(graph, start, end, NoEstimate(), state, observer);
+}
+
+float DiagonalDistance(const Grid &graph, UInt32 node, UInt32 end)
+{
+	// Absolute value of horizontal and vertical distance from this node to the end node.
+	float dx = abs(static_cast<float>(graph.X(node)) - static_cast<float>(graph.X(end))); // Casted to floats.
+	float dy = abs(static_cast<float>(graph.Y(node)) - static_cast<float>(graph.Y(end)));
+	return (dx + dy) + (kSquareRoot2 - 2) * min(dx, dy); // Takes diagonals in to account.
+}
+
+float ManhattanDistance(const Grid &graph, UInt32 node, UInt32 end)
+{
+	float dx = abs(static_cast<float>(graph.X(node)) - static_cast<float>(graph.X(end)));
+	float dy = abs(static_cast<float>(graph.Y(node)) - static_cast<float>(graph.Y(end)));
+	return dx + dy;
+}
+
+float GridDistance(const Grid &graph, UInt32 node, UInt32 end)
+{
+	return (graph.Movement() == FOUR_CONNECTED) ? ManhattanDistance(graph, node, end) : DiagonalDistance(graph, node, end);
+}
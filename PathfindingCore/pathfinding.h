@@ -0,0 +1,79 @@
+#pragma once
+#include <vector>
+#include "grid.h"
+#include "search_state.h"
+#include "landmarks.h"
+#include "search_stats.h"
+
+// The pathfinding core has no dependency on SFML, so it can be used by headless tools as well as the visual demo.
+enum Algorithm // An enum value to represent an algorithm
+{
+	A_STAR_DIAGONAL,
+	A_STAR_MANHATTAN,
+	DIJKSTRA,
+	JUMP_POINT_SEARCH,
+	BIDIRECTIONAL_DIJKSTRA,
+	BIDIRECTIONAL_A_STAR,
+	HIERARCHICAL_A_STAR,
+	D_STAR_LITE,
+	A_STAR_LANDMARKS,
+	DIAL_DIJKSTRA,
+	DIAL_A_STAR
+};
+const int kAlgorithmCount = 11;
+const char *AlgorithmName(Algorithm algorithm); // Never has a comma, the benchmark writes it to CSV unquoted.
+// The algorithm FindPath() really runs for algorithm on this grid. Jump point search runs A* on a grid with cell costs or
+// where diagonal moves cut corners, and the bucket searches run the heap based ones on an 8-connected grid.
+Algorithm SearchedAlgorithm(const Grid &graph, Algorithm algorithm);
+
+// Receives progress from a search, this is how the visual demo colours the squares as the algorithm runs.
+class SearchObserver
+{
+public:
+	virtual ~SearchObserver() {};
+	virtual void NodeOpened(UInt32 /*node*/) {}; // Called when a node is added to the open set.
+	virtual void NodeClosed(UInt32 /*node*/) {}; // Called once a node has been expanded (all neighbours have been looked at).
+	virtual void NodeRelaxed(UInt32 /*node*/) {}; // Called when a shorter route is found to a node already in the open set.
+	// Asked after each node is closed, once it returns true the search stops and returns with no path.
+	virtual bool Cancelled() const { return false; };
+};
+
+struct SearchResult
+{
+	std::vector<UInt32> path; // Grid indices from the start node to the end node, empty if there is no path.
+	bool path_found;
+	float path_length;
+	UInt32 nodes_expanded; // Number of nodes moved to the closed set.
+	float duration; // Time taken in seconds (this includes any time spent in the observer).
+	SearchStats stats;
+	SearchResult()
+		: path_found(false), path_length(0), nodes_expanded(0), duration(0) {};
+};
+
+// The search state can be kept between searches, so that running a search does not allocate. The grid is only read.
+// Every search reports no path when the start or end node is blocked, even when they are the same node.
+// HIERARCHICAL_A_STAR builds its abstraction of the grid for the one search, keep a HierarchicalPathfinder to reuse it.
+// Likewise D_STAR_LITE searches from scratch, keep a DStarLite to repair the last search when the grid changes, and
+// A_STAR_LANDMARKS builds the landmark tables for the one search, build a Landmarks and use LandmarkAStar to reuse them.
+// BatchPathfinder builds each of these once for a batch.
+SearchResult FindPath(const Grid &graph, UInt32 start, UInt32 end, Algorithm algorithm, SearchState &state, SearchObserver *observer = nullptr);
+SearchResult FindPath(const Grid &graph, UInt32 start, UInt32 end, Algorithm algorithm, SearchObserver *observer = nullptr);
+SearchResult DijkstrasAlgorithm(const Grid &graph, UInt32 start, UInt32 end, SearchState &state, SearchObserver *observer = nullptr);
+SearchResult AStarAlgorithm(const Grid &graph, UInt32 start, UInt32 end, Algorithm heuristic, SearchState &state, SearchObserver *observer = nullptr);
+// Dijkstra (heuristic DIJKSTRA) or A* (A_STAR_MANHATTAN) keeping the open set in a bucket queue instead of a heap. Every
+// cost is a whole number, so every key is too, and the queue never has to compare them. That is not so once diagonal
+// moves are allowed, and on an 8-connected grid this runs the heap based Dijkstra or A* (Diagonal) instead.
+SearchResult BucketSearch(const Grid &graph, UInt32 start, UInt32 end, Algorithm heuristic, SearchState &state, SearchObserver *observer = nullptr);
+// A* estimating with the landmark tables, which must be up to date with the grid, or GridDistance() if that is higher.
+SearchResult LandmarkAStar(const Grid &graph, UInt32 start, UInt32 end, const Landmarks &landmarks, SearchState &state, SearchObserver *observer = nullptr);
+// Only for grids where every cell costs the same to move in to, the cost of each cell is ignored. Takes its moves from the
+// grid and never cuts corners. FindPath() runs A* instead on a grid that has cell costs, or that allows cutting corners.
+SearchResult JumpPointSearch(const Grid &graph, UInt32 start, UInt32 end, SearchState &state, SearchObserver *observer = nullptr);
+// Searches from both ends at once, heuristic is DIJKSTRA for no heuristic or one of the A* heuristics.
+// The search back from the end node uses state.Reverse().
+SearchResult BidirectionalSearch(const Grid &graph, UInt32 start, UInt32 end, Algorithm heuristic, SearchState &state, SearchObserver *observer = nullptr);
+// Heuristics (estimates of distance to the end node). Manhattan distance is too high on an 8-connected grid, so A*
+// (Manhatten) can return a longer path than the shortest there.
+float DiagonalDistance(const Grid &graph, UInt32 node, UInt32 end); // Octile distance, exact on an empty 8-connected grid.
+float ManhattanDistance(const Grid &graph, UInt32 node, UInt32 end);
+float GridDistance(const Grid &graph, UInt32 node, UInt32 end); // Whichever of the two suits the grid's moves.
@@ -0,0 +1,78 @@
+#pragma once
+#include <algorithm>
+#include <type_traits>
+#include "pathfinding.h"
+
+// Policies the search loops are compiled with, so that the choice of heuristic, moves and observer is made once per
+// query rather than once per node. Each search is a template over them, and DispatchSearch() picks the instantiation.
+
+// Estimates of the distance between two nodes, each one is a function object so that it is inlined in to the loop.
+struct NoEstimate // Dijkstra.
+{
+	float operator()(UInt32 /*node*/, UInt32 /*target*/) const { return 0; };
+};
+
+struct ManhattanEstimate
+{
+	const Grid &graph;
+	explicit ManhattanEstimate(const Grid &g)
+		: graph(g) {};
+	float operator()(UInt32 node, UInt32 target) const { return ManhattanDistance(graph, node, target); };
+};
+
+struct DiagonalEstimate
+{
+	const Grid &graph;
+	explicit DiagonalEstimate(const Grid &g)
+		: graph(g) {};
+	float operator()(UInt32 node, UInt32 target) const { return DiagonalDistance(graph, node, target); };
+};
+
+// The landmark lower bound, or the distance on an empty grid if that is higher. Both are lower bounds, so the higher is the better estimate.
+template <typename GridEstimate>
+struct LandmarkEstimate
+{
+	const Grid &graph;
+	const Landmarks &landmarks;
+	GridEstimate grid_estimate;
+	LandmarkEstimate(const Grid &g, const Landmarks &l)
+		: graph(g), landmarks(l), grid_estimate(g) {};
+	float operator()(UInt32 node, UInt32 target) const { return std::max(landmarks.LowerBound(graph, node, target), grid_estimate(node, target)); };
+};
+
+// The moves a search takes, as a type so that Grid::Moves() is compiled for just the one connectivity.
+typedef std::integral_constant<Connectivity, FOUR_CONNECTED> FourConnectedMoves;
+typedef std::integral_constant<Connectivity, EIGHT_CONNECTED> EightConnectedMoves;
+
+// What a search reports as it goes, nothing at all when there is no observer.
+struct NoReport
+{
+	void Opened(UInt32 /*node*/) const {};
+	void Closed(UInt32 /*node*/) const {};
+	void Relaxed(UInt32 /*node*/) const {};
+	bool Cancelled() const { return false; };
+};
+
+struct ObserverReport
+{
+	SearchObserver *observer; // Never null.
+	explicit ObserverReport(SearchObserver *o)
+		: observer(o) {};
+	void Opened(UInt32 node) const { observer->NodeOpened(node); };
+	void Closed(UInt32 node) const { observer->NodeClosed(node); };
+	void Relaxed(UInt32 node) const { observer->NodeRelaxed(node); };
+	bool Cancelled() const { return observer->Cancelled(); };
+};
+
+// Calls search(moves, report) with the moves of the grid and the report for the observer, a function object taking
+// both by value lets one generic lambda stand for every instantiation of a search template.
+template <typename Search>
+SearchResult DispatchSearch(const Grid &graph, SearchObserver *observer, const Search &search)
+{
+	if (observer == nullptr)
+	{
+		return (graph.Movement() == FOUR_CONNECTED) ? search(FourConnectedMoves(), NoReport()) : search(EightConnectedMoves(), NoReport());
+	}
+	ObserverReport report(observer);
+	return (graph.Movement() == FOUR_CONNECTED) ? search(FourConnectedMoves(), report) : search(EightConnectedMoves(), report);
+}
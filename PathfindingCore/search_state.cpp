@@ -0,0 +1,44 @@
+#include "search_state.h"
+
+SearchState::SearchState()
+	: open_stamp_(0)
+{
+}
+
+void SearchState::Begin(unsigned int node_count)
+{
+	open_set_.Clear(); // Only touches whatever was left in the open set by the last search.
+	if (node_count > nodes_.size())
+	{
+		NodeState unvisited = { 0, 0, kNoParent, 0 };
+		nodes_.resize(node_count, unvisited);
+	}
+	if (open_stamp_ >= 0xFFFFFFFF - 3) // The stamp is about to wrap around, this happens once every 2 billion searches.
+	{
+		for (NodeState &node : nodes_)
+		{
+			node.stamp = 0;
+		}
+		open_stamp_ = 0;
+	}
+	open_stamp_ += 2;
+}
+
+SearchState &SearchState::Reverse()
+{
+	if (!reverse_)
+	{
+		reverse_.reset(new SearchState());
+	}
+	return *reverse_;
+}
+
+unsigned long long SearchState::HeapOperations() const
+{
+	return open_set_.Operations() + buckets_.Operations() + (reverse_ ? reverse_->HeapOperations() : 0);
+}
+
+size_t SearchState::MemoryUsage() const
+{
+	return nodes_.capacity() * sizeof(NodeState) + open_set_.MemoryUsage() + buckets_.MemoryUsage() + (reverse_ ? reverse_->MemoryUsage() : 0);
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include <vector>
+#include <limits>
+#include <memory>
+#include "indexed_heap.h"
+#include "bucket_queue.h"
+
+// The open set is ordered by f-cost, ties are broken by the lower h-cost as that node is likely to be closer to the end.
+struct OpenSetKey
+{
+	float f_cost;
+	float h_cost;
+	OpenSetKey(float f, float h)
+		: f_cost(f), h_cost(h) {};
+	bool operator<(const OpenSetKey &other) const
+	{
+		return (f_cost < other.f_cost) || ((f_cost == other.f_cost) && (h_cost < other.h_cost));
+	}
+};
+
+// Holds everything a search writes about the nodes (by grid index), so the grid itself is never modified by a search.
+// Each node has a stamp that records the last search that touched it. Starting a new search only moves the
+// generation on, so nothing needs to be cleared, and a node is open/closed when its stamp matches this search.
+class SearchState
+{
+public:
+	static const unsigned int kNoParent = 0xFFFFFFFF;
+
+	SearchState();
+	void Begin(unsigned int node_count); // Call once at the start of every search, this is O(1) unless the grid has grown.
+
+	bool Visited(unsigned int index) const { return nodes_[index].stamp >= open_stamp_; }; // Open or closed in this search.
+	bool InOpenSet(unsigned int index) const { return nodes_[index].stamp == open_stamp_; };
+	bool Closed(unsigned int index) const { return nodes_[index].stamp == open_stamp_ + 1; };
+	float GCost(unsigned int index) const { return Visited(index) ? nodes_[index].g_cost : std::numeric_limits<float>::infinity(); };
+	float HCost(unsigned int index) const { return nodes_[index].h_cost; };
+	unsigned int Parent(unsigned int index) const { return nodes_[index].parent; };
+
+	// Writes the costs of a node reached for the first time and adds it to the open set.
+	void Open(unsigned int index, float g_cost, float h_cost, unsigned int parent)
+	{
+		NodeState &state = nodes_[index];
+		state.g_cost = g_cost;
+		state.h_cost = h_cost;
+		state.parent = parent;
+		state.stamp = open_stamp_;
+		open_set_.Push(index, OpenSetKey(g_cost + h_cost, h_cost));
+	}
+	// A shorter route to a node already in the open set has been found.
+	void Relax(unsigned int index, float g_cost, unsigned int parent)
+	{
+		NodeState &state = nodes_[index];
+		state.g_cost = g_cost;
+		state.parent = parent;
+		open_set_.DecreaseKey(index, OpenSetKey(g_cost + state.h_cost, state.h_cost));
+	}
+	void Close(unsigned int index) { nodes_[index].stamp = open_stamp_ + 1; };
+	// For searches that keep their open set in Buckets(): writes the costs as Open() or Relax() would, without the heap.
+	void Reach(unsigned int index, float g_cost, float h_cost, unsigned int parent)
+	{
+		NodeState &state = nodes_[index];
+		state.g_cost = g_cost;
+		state.h_cost = h_cost;
+		state.parent = parent;
+		state.stamp = open_stamp_;
+	}
+
+	IndexedHeap<OpenSetKey> &OpenSet() { return open_set_; };
+	BucketQueue &Buckets() { return buckets_; }; // Only emptied by BucketQueue::Begin().
+	SearchState &Reverse(); // A second state for searching back from the end node, only created by bidirectional searches.
+	unsigned long long HeapOperations() const; // Total for the open sets of this state and its reverse state, for measuring searches.
+	size_t MemoryUsage() const; // Bytes allocated by this state and its reverse state.
+
+private:
+	struct NodeState // Kept together so that looking at a node only touches one cache line.
+	{
+		float g_cost; // Distance to this node.
+		float h_cost; // Estimated distance from this node to the end node.
+		unsigned int parent; // Index of the node this was reached from.
+		unsigned int stamp; // open_stamp_ of the last search that reached this node, or one more than that once it is closed.
+	};
+
+	std::vector<NodeState> nodes_;
+	IndexedHeap<OpenSetKey> open_set_;
+	BucketQueue buckets_;
+	std::unique_ptr<SearchState> reverse_;
+	unsigned int open_stamp_; // Goes up by 2 for every search, so a node from an earlier search is always below it.
+};
@@ -0,0 +1,113 @@
+#include "search_stats.h"
+#include "pathfinding.h"
+
+SearchStatsHistogram::SearchStatsHistogram()
+{
+	Clear();
+}
+
+void SearchStatsHistogram::Add(const SearchResult &result)
+{
+	searches_++;
+	AddValue(NODES_EXPANDED, result.nodes_expanded);
+	AddValue(NODES_GENERATED, result.stats.nodes_generated);
+	AddValue(DECREASE_KEYS, result.stats.decrease_keys);
+	AddValue(REOPENS, result.stats.reopens);
+	AddValue(PEAK_OPEN, result.stats.peak_open);
+	AddValue(PEAK_MEMORY, result.stats.peak_memory);
+	AddValue(SEARCH_TIME, static_cast<UInt64>(result.stats.search_time * 1e9));
+	AddValue(PATH_TIME, static_cast<UInt64>(result.stats.path_time * 1e9));
+}
+
+void SearchStatsHistogram::Add(const SearchStatsHistogram &other)
+{
+	searches_ += other.searches_;
+	for (int metric = 0; metric < kMetricCount; metric++)
+	{
+		for (int bucket = 0; bucket < kBucketCount; bucket++)
+		{
+			counts_[metric][bucket] += other.counts_[metric][bucket];
+		}
+		totals_[metric] += other.totals_[metric];
+		if (other.maxima_[metric] > maxima_[metric])
+		{
+			maxima_[metric] = other.maxima_[metric];
+		}
+	}
+}
+
+void SearchStatsHistogram::Clear()
+{
+	searches_ = 0;
+	for (int metric = 0; metric < kMetricCount; metric++)
+	{
+		for (int bucket = 0; bucket < kBucketCount; bucket++)
+		{
+			counts_[metric][bucket] = 0;
+		}
+		totals_[metric] = 0;
+		maxima_[metric] = 0;
+	}
+}
+
+void SearchStatsHistogram::AddValue(Metric metric, UInt64 value)
+{
+	int bucket = 0;
+	for (UInt64 rest = value; rest != 0; rest >>= 1)
+	{
+		bucket++;
+	}
+	counts_[metric][bucket]++;
+	totals_[metric] += value;
+	if (value > maxima_[metric])
+	{
+		maxima_[metric] = value;
+	}
+}
+
+const char *SearchStatsHistogram::MetricName(Metric metric)
+{
+	switch (metric)
+	{
+	case NODES_EXPANDED:
+		return "nodes_expanded";
+	case NODES_GENERATED:
+		return "nodes_generated";
+	case DECREASE_KEYS:
+		return "decrease_keys";
+	case REOPENS:
+		return "reopens";
+	case PEAK_OPEN:
+		return "peak_open";
+	case PEAK_MEMORY:
+		return "peak_memory_bytes";
+	case SEARCH_TIME:
+		return "search_ns";
+	case PATH_TIME:
+		return "path_ns";
+	default:
+		return "unknown";
+	}
+}
+
+void SearchStatsHistogram::WriteHeader(std::ostream &out)
+{
+	out << "label,metric,low,high,count" << std::endl;
+}
+
+void SearchStatsHistogram::Write(std::ostream &out, const std::string &label) const
+{
+	for (int metric = 0; metric < kMetricCount; metric++)
+	{
+		for (int bucket = 0; bucket < kBucketCount; bucket++)
+		{
+			if (counts_[metric][bucket] == 0)
+			{
+				continue;
+			}
+			UInt64 low = (bucket == 0) ? 0 : (1ULL << (bucket - 1));
+			UInt64 high = (bucket == 0) ? 0 : (low - 1) + low; // 2^bucket - 1 without overflowing for the last bucket.
+			out << "\"" << label << "\"," << MetricName(static_cast<Metric>(metric)) << "," << low << "," << high << "," << counts_[metric][bucket] << std::endl;
+		}
+	}
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <chrono>
+#include <ostream>
+#include <string>
+#include "occupancy_bits.h"
+
+struct SearchResult;
+
+// What a search did besides find its path, so that a slow search can be explained. Every search fills in what applies to
+// it and leaves the rest at 0. The nodes expanded and the total time are nodes_expanded and duration in SearchResult.
+struct SearchStats
+{
+	UInt32 nodes_generated; // Nodes put in the open set for the first time, the start node included.
+	UInt32 decrease_keys; // Shorter routes found to nodes already in the open set, pushed again by the bucket searches and re-keyed by D* Lite.
+	UInt32 reopens; // Expansions of nodes that had been expanded before, only D* Lite puts a node back in the open set.
+	UInt32 peak_open; // Most nodes in the open set at once, the two open sets added together for bidirectional searches.
+	size_t peak_memory; // Bytes held by the search when it finished, nothing is freed during a search so this is the peak.
+	float search_time; // Seconds, duration is this plus path_time.
+	float path_time; // Seconds spent building the path once the search had finished, refining it for HPA*.
+	SearchStats()
+		: nodes_generated(0), decrease_keys(0), reopens(0), peak_open(0), peak_memory(0), search_time(0), path_time(0) {};
+};
+
+// Splits the time taken by a search between searching and building the path.
+class SearchTimer
+{
+public:
+	SearchTimer()
+		: start_time_(std::chrono::steady_clock::now()), path_start_time_(start_time_) {};
+
+	void PathStarted() { path_start_time_ = std::chrono::steady_clock::now(); }; // If it is never called all of the time was spent searching.
+	float Finish(SearchStats &stats) // Fills in the times of the stats and returns the total.
+	{
+		auto end_time = std::chrono::steady_clock::now();
+		if (path_start_time_ == start_time_)
+		{
+			path_start_time_ = end_time;
+		}
+		stats.search_time = std::chrono::duration<float>(path_start_time_ - start_time_).count();
+		stats.path_time = std::chrono::duration<float>(end_time - path_start_time_).count();
+		return std::chrono::duration<float>(end_time - start_time_).count();
+	};
+
+private:
+	std::chrono::steady_clock::time_point start_time_, path_start_time_;
+};
+
+// Collects the stats of many searches, for batch runs where a mean would hide the few searches that take all the time.
+// Each value goes in to a bucket by its highest set bit, so one histogram covers searches from a few nodes to a whole map.
+class SearchStatsHistogram
+{
+public:
+	enum Metric
+	{
+		NODES_EXPANDED,
+		NODES_GENERATED,
+		DECREASE_KEYS,
+		REOPENS,
+		PEAK_OPEN,
+		PEAK_MEMORY, // Bytes.
+		SEARCH_TIME, // Nanoseconds.
+		PATH_TIME
+	};
+	static const int kMetricCount = 8;
+	static const int kBucketCount = 65; // Bucket 0 holds 0, bucket b holds 2^(b-1) to 2^b - 1.
+
+	SearchStatsHistogram();
+	void Add(const SearchResult &result);
+	void Add(const SearchStatsHistogram &other);
+	void Clear();
+
+	UInt64 Searches() const { return searches_; };
+	UInt64 Count(Metric metric, int bucket) const { return counts_[metric][bucket]; };
+	UInt64 Total(Metric metric) const { return totals_[metric]; };
+	UInt64 Max(Metric metric) const { return maxima_[metric]; };
+	static const char *MetricName(Metric metric);
+
+	// One CSV line per non-empty bucket: label,metric,low,high,count with the label in quotes. WriteHeader() writes the column names.
+	static void WriteHeader(std::ostream &out);
+	void Write(std::ostream &out, const std::string &label) const;
+
+private:
+	void AddValue(Metric metric, UInt64 value);
+
+	UInt64 searches_;
+	UInt64 counts_[kMetricCount][kBucketCount];
+	UInt64 totals_[kMetricCount];
+	UInt64 maxima_[kMetricCount];
+};
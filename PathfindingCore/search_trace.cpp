@@ -0,0 +1,351 @@
+#include "search_trace.h"
+#include "mapped_file.h"
+#include <cstring>
+#include <utility>
+
+namespace
+{
+	UInt64 ZigZag(long long value) { return (static_cast<UInt64>(value) << 1) ^ static_cast<UInt64>(value >> 63); };
+	long long UnZigZag(UInt64 value) { return static_cast<long long>(value >> 1) ^ -static_cast<long long>(value & 1); };
+
+	// Reads the numbers of a trace out of the mapped file in place.
+	class TraceReader
+	{
+	public:
+		TraceReader(const MappedFile &file, size_t offset)
+			: position_(file.Data() + offset), end_(file.Data() + file.Size())
+		{
+		}
+
+		bool AtEnd() const { return position_ == end_; };
+
+		// Returns false at the end of the file, or if the number runs past it or does not fit in 64 bits.
+		bool NextNumber(UInt64 &value)
+		{
+			value = 0;
+			for (int shift = 0; shift < 64; shift += 7)
+			{
+				if (position_ == end_)
+				{
+					return false;
+				}
+				UInt8 byte = *position_++;
+				value |= static_cast<UInt64>(byte & 0x7F) << shift;
+				if ((byte & 0x80) == 0)
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+		bool NextUInt(UInt32 &value)
+		{
+			UInt64 number;
+			if (!NextNumber(number) || number > 0xFFFFFFFF)
+			{
+				return false;
+			}
+			value = static_cast<UInt32>(number);
+			return true;
+		}
+
+		bool NextFloat(float &value)
+		{
+			UInt32 bits;
+			if (!NextUInt(bits))
+			{
+				return false;
+			}
+			std::memcpy(&value, &bits, sizeof(value));
+			return true;
+		}
+
+		// A node written as a delta from last_node, which becomes the node. Returns false if it is outside the grid.
+		static bool NodeFromDelta(UInt64 zig_zag, UInt32 node_count, UInt32 &last_node)
+		{
+			long long node = static_cast<long long>(last_node) + UnZigZag(zig_zag);
+			if (node < 0 || node >= node_count)
+			{
+				return false;
+			}
+			last_node = static_cast<UInt32>(node);
+			return true;
+		}
+
+	private:
+		const UInt8 *position_;
+		const UInt8 *end_;
+	};
+
+	bool ReadSearchEnd(TraceReader &reader, UInt32 node_count, UInt32 last_node, SearchResult &result)
+	{
+		UInt32 path_size, path_found;
+		if (!reader.NextUInt(path_size) || path_size > node_count)
+		{
+			return false;
+		}
+		result.path.resize(path_size);
+		for (UInt32 &path_node : result.path)
+		{
+			UInt64 delta;
+			if (!reader.NextNumber(delta) || !TraceReader::NodeFromDelta(delta, node_count, last_node))
+			{
+				return false;
+			}
+			path_node = last_node;
+		}
+		SearchStats &stats = result.stats;
+		UInt64 peak_memory;
+		if (!(reader.NextUInt(path_found) && reader.NextFloat(result.path_length) && reader.NextUInt(result.nodes_expanded) && reader.NextFloat(result.duration) &&
+			reader.NextUInt(stats.nodes_generated) && reader.NextUInt(stats.decrease_keys) && reader.NextUInt(stats.reopens) && reader.NextUInt(stats.peak_open) &&
+			reader.NextNumber(peak_memory) && reader.NextFloat(stats.search_time) && reader.NextFloat(stats.path_time)))
+		{
+			return false;
+		}
+		result.path_found = (path_found != 0);
+		stats.peak_memory = static_cast<size_t>(peak_memory);
+		return true;
+	}
+}
+
+SearchTraceWriter::SearchTraceWriter()
+	: buffer_(kBufferSize), used_(0), last_node_(0), grid_version_(0), observer_(nullptr)
+{
+}
+
+SearchTraceWriter::~SearchTraceWriter()
+{
+	Close();
+}
+
+bool SearchTraceWriter::Open(const std::string &path)
+{
+	Close();
+	file_.open(path, std::ios::binary | std::ios::trunc);
+	if (!file_)
+	{
+		file_.close();
+		return false;
+	}
+	TraceFileHeader header;
+	std::memcpy(header.magic, "PTRC", 4);
+	header.version = kTraceFileVersion;
+	file_.write(reinterpret_cast<const char *>(&header), sizeof(header));
+	grid_version_ = 0;
+	return static_cast<bool>(file_);
+}
+
+bool SearchTraceWriter::Close()
+{
+	if (!file_.is_open())
+	{
+		return true;
+	}
+	Flush();
+	bool written = static_cast<bool>(file_);
+	file_.close();
+	return written;
+}
+
+void SearchTraceWriter::BeginSearch(const Grid &graph, Algorithm algorithm, UInt32 start, UInt32 end)
+{
+	if (graph.Version() != grid_version_) // Versions are never reused, so this is also a different grid.
+	{
+		grid_version_ = graph.Version();
+		WriteControl(TRACE_GRID);
+		WriteNumber(graph.Width());
+		WriteNumber(graph.Height());
+		WriteNumber(graph.Movement());
+		WriteNumber(graph.CornerRule());
+		WriteNumber(graph.ContentHash());
+	}
+	WriteControl(TRACE_SEARCH_BEGIN);
+	WriteNumber(algorithm);
+	WriteNumber(start);
+	WriteNumber(end);
+	last_node_ = start;
+}
+
+void SearchTraceWriter::EndSearch(const SearchResult &result)
+{
+	if (Cancelled())
+	{
+		WriteControl(TRACE_SEARCH_CANCELLED);
+		return;
+	}
+	WriteControl(TRACE_SEARCH_END);
+	WriteNumber(result.path.size());
+	for (UInt32 path_node : result.path)
+	{
+		WriteNumber(ZigZag(static_cast<long long>(path_node) - last_node_));
+		last_node_ = path_node;
+	}
+	WriteNumber(result.path_found ? 1 : 0);
+	WriteFloat(result.path_length);
+	WriteNumber(result.nodes_expanded);
+	WriteFloat(result.duration);
+	const SearchStats &stats = result.stats;
+	WriteNumber(stats.nodes_generated);
+	WriteNumber(stats.decrease_keys);
+	WriteNumber(stats.reopens);
+	WriteNumber(stats.peak_open);
+	WriteNumber(stats.peak_memory);
+	WriteFloat(stats.search_time);
+	WriteFloat(stats.path_time);
+}
+
+void SearchTraceWriter::NodeOpened(UInt32 node)
+{
+	WriteNode(TRACE_OPENED, node);
+	if (observer_ != nullptr)
+	{
+		observer_->NodeOpened(node);
+	}
+}
+
+void SearchTraceWriter::NodeClosed(UInt32 node)
+{
+	WriteNode(TRACE_CLOSED, node);
+	if (observer_ != nullptr)
+	{
+		observer_->NodeClosed(node);
+	}
+}
+
+void SearchTraceWriter::NodeRelaxed(UInt32 node)
+{
+	WriteNode(TRACE_RELAXED, node);
+	if (observer_ != nullptr)
+	{
+		observer_->NodeRelaxed(node);
+	}
+}
+
+void SearchTraceWriter::WriteNode(TraceRecord kind, UInt32 node)
+{
+	WriteNumber((ZigZag(static_cast<long long>(node) - last_node_) << 2) | kind);
+	last_node_ = node;
+}
+
+void SearchTraceWriter::WriteNumber(UInt64 value)
+{
+	if (used_ + 10 > buffer_.size()) // The longest a number can take.
+	{
+		Flush();
+	}
+	while (value >= 0x80)
+	{
+		buffer_[used_++] = static_cast<UInt8>(value | 0x80);
+		value >>= 7;
+	}
+	buffer_[used_++] = static_cast<UInt8>(value);
+}
+
+void SearchTraceWriter::WriteFloat(float value)
+{
+	UInt32 bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	WriteNumber(bits);
+}
+
+void SearchTraceWriter::Flush()
+{
+	if (file_.is_open() && used_ > 0)
+	{
+		file_.write(reinterpret_cast<const char *>(buffer_.data()), used_);
+	}
+	used_ = 0;
+}
+
+bool LoadSearchTrace(const std::string &path, std::vector<SearchTrace> &searches)
+{
+	MappedFile file;
+	if (!file.Open(path) || file.Size() < sizeof(TraceFileHeader))
+	{
+		return false;
+	}
+	TraceFileHeader header;
+	std::memcpy(&header, file.Data(), sizeof(header));
+	if (std::memcmp(header.magic, "PTRC", 4) != 0 || header.version != kTraceFileVersion)
+	{
+		return false;
+	}
+	searches.clear();
+	TraceReader reader(file, sizeof(TraceFileHeader));
+	UInt32 width = 0, height = 0, last_node = 0;
+	UInt32 connectivity = FOUR_CONNECTED, corner_cutting = NO_CORNER_CUTTING;
+	UInt64 grid_hash = 0;
+	SearchTrace search;
+	bool in_search = false;
+	UInt64 record;
+	while (reader.NextNumber(record))
+	{
+		UInt32 node_count = width * height;
+		TraceRecord kind = static_cast<TraceRecord>(record & 3);
+		if (kind != TRACE_CONTROL)
+		{
+			if (!in_search || !TraceReader::NodeFromDelta(record >> 2, node_count, last_node))
+			{
+				return false;
+			}
+			TraceEvent event;
+			event.node = last_node;
+			event.kind = kind;
+			search.events.push_back(event);
+			continue;
+		}
+		switch (record >> 2)
+		{
+		case TRACE_GRID:
+			if (in_search || !reader.NextUInt(width) || !reader.NextUInt(height) || static_cast<UInt64>(width) * height > 0xFFFFFFFF ||
+				!reader.NextUInt(connectivity) || !reader.NextUInt(corner_cutting) || !reader.NextNumber(grid_hash) ||
+				connectivity > EIGHT_CONNECTED || corner_cutting > CUT_BOTH_CORNERS)
+			{
+				return false;
+			}
+			break;
+		case TRACE_SEARCH_BEGIN:
+		{
+			UInt32 algorithm;
+			search = SearchTrace();
+			if (in_search || !reader.NextUInt(algorithm) || !reader.NextUInt(search.start) || !reader.NextUInt(search.end) ||
+				algorithm >= kAlgorithmCount || search.start >= node_count || search.end >= node_count)
+			{
+				return false;
+			}
+			search.width = width;
+			search.height = height;
+			search.connectivity = static_cast<Connectivity>(connectivity);
+			search.corner_cutting = static_cast<CornerCutting>(corner_cutting);
+			search.grid_hash = grid_hash;
+			search.algorithm = static_cast<Algorithm>(algorithm);
+			last_node = search.start;
+			in_search = true;
+			break;
+		}
+		case TRACE_SEARCH_END:
+			if (!in_search)
+			{
+				return false;
+			}
+			if (!ReadSearchEnd(reader, node_count, last_node, search.result))
+			{
+				return reader.AtEnd(); // Cut off part way through the last search.
+			}
+			searches.push_back(std::move(search));
+			in_search = false;
+			break;
+		case TRACE_SEARCH_CANCELLED:
+			if (!in_search)
+			{
+				return false;
+			}
+			in_search = false;
+			break;
+		default:
+			return false;
+		}
+	}
+	return reader.AtEnd(); // Otherwise a number was too long to be one.
+}
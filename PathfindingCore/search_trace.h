@@ -0,0 +1,97 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <fstream>
+#include "pathfinding.h"
+
+// Recording of what searches did, so that a slow query can be replayed and looked at long after it ran, without running
+// the algorithm again and without drawing anything while it runs.
+//
+// A trace file is a TraceFileHeader followed by records. Each record starts with a number whose two low bits are its
+// TraceRecord kind. For the node records the rest of the number is the node's index less the index of the node
+// recorded before it, zig-zag encoded (0, -1, 1, -2... become 0, 1, 2, 3...) so that a step to a neighbour takes a byte
+// or two. For TRACE_CONTROL the rest is a TraceControl code, and the numbers it lists follow. Numbers are written 7 bits
+// a byte, low bits first, with the top bit set on every byte but the last. Floats are written as their bits.
+struct TraceFileHeader
+{
+	char magic[4]; // "PTRC"
+	UInt32 version;
+};
+const UInt32 kTraceFileVersion = 3;
+
+enum TraceRecord : UInt8 { TRACE_OPENED, TRACE_CLOSED, TRACE_RELAXED, TRACE_CONTROL }; // The observer's events, or TRACE_CONTROL.
+enum TraceControl : UInt8
+{
+	// Width, height, connectivity, corner cutting and Grid::ContentHash(), before the first search and whenever the
+	// grid has changed since the last one.
+	TRACE_GRID,
+	TRACE_SEARCH_BEGIN, // Algorithm, start and end, the start is the node before the first node record.
+	// The number of path nodes and each one as a delta like the node records, then path found (0 or 1), path length,
+	// nodes expanded, duration, and the SearchStats in the order they are declared.
+	TRACE_SEARCH_END,
+	TRACE_SEARCH_CANCELLED // Ends a search the observer cancelled, it has no result and is left out when read back.
+};
+
+struct TraceEvent
+{
+	UInt32 node;
+	TraceRecord kind; // Never TRACE_CONTROL.
+};
+
+// One search read back from a trace.
+struct SearchTrace
+{
+	UInt32 width, height; // Of the grid searched.
+	Connectivity connectivity;
+	CornerCutting corner_cutting;
+	UInt64 grid_hash; // Grid::ContentHash(), the search can only be replayed on a grid with the same hash and moves.
+	Algorithm algorithm;
+	UInt32 start, end;
+	std::vector<TraceEvent> events;
+	SearchResult result;
+};
+
+// Records every search on the searching thread, as its observer. Records are built in a buffer that is written to the
+// file when it is full, so a search costs a few bytes of memory per event and almost never waits for the disk. Events
+// can be passed on to another observer as well, for a search that is also being drawn.
+class SearchTraceWriter : public SearchObserver
+{
+public:
+	static const size_t kBufferSize = 1 << 16; // Bytes.
+
+	SearchTraceWriter();
+	~SearchTraceWriter(); // Closes the file.
+
+	bool Open(const std::string &path); // Replaces the file, returns false if it can not be written.
+	bool IsOpen() const { return file_.is_open(); };
+	bool Close(); // Writes what is left in the buffer, returns false if any write failed.
+	void PassOn(SearchObserver *observer) { observer_ = observer; }; // Null to stop passing them on.
+
+	void BeginSearch(const Grid &graph, Algorithm algorithm, UInt32 start, UInt32 end);
+	void EndSearch(const SearchResult &result);
+	void NodeOpened(UInt32 node) override;
+	void NodeClosed(UInt32 node) override;
+	void NodeRelaxed(UInt32 node) override;
+	bool Cancelled() const override { return observer_ != nullptr && observer_->Cancelled(); }; // Asks the observer passed on to.
+
+private:
+	SearchTraceWriter(const SearchTraceWriter &);
+	SearchTraceWriter &operator=(const SearchTraceWriter &);
+
+	void WriteNode(TraceRecord kind, UInt32 node);
+	void WriteControl(TraceControl control) { WriteNumber((static_cast<UInt64>(control) << 2) | TRACE_CONTROL); };
+	void WriteNumber(UInt64 value);
+	void WriteFloat(float value);
+	void Flush();
+
+	std::ofstream file_;
+	std::vector<UInt8> buffer_;
+	size_t used_; // Bytes of buffer_ not written yet.
+	UInt32 last_node_; // The node the next node record is a delta from.
+	UInt64 grid_version_; // Grid::Version() at the last TRACE_GRID record, 0 before the first.
+	SearchObserver *observer_;
+};
+
+// Reads every complete search in the file, a search cut off by the end of the file (the writer was stopped) is left
+// out. Returns false if the file can not be read or is not a trace.
+bool LoadSearchTrace(const std::string &path, std::vector<SearchTrace> &searches);
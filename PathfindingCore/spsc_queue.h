@@ -0,0 +1,80 @@
+#pragma once
+#include <vector>
+#include <atomic>
+#include <cstddef>
+
+// A fixed size ring buffer that passes values from one thread (the producer) to one other thread (the consumer) without
+// locks. Only the producer writes tail_ and only the consumer writes head_, and each keeps its last sight of the other's
+// index, so the cache line holding that index only moves between the cores when the queue looks full or empty.
+template <typename T>
+class SpscQueue
+{
+public:
+	explicit SpscQueue(size_t capacity) // Rounded up to a power of 2.
+		: head_(0), tail_cache_(0), tail_(0), head_cache_(0)
+	{
+		size_t size = 1;
+		while (size < capacity)
+		{
+			size *= 2;
+		}
+		buffer_.resize(size);
+		mask_ = size - 1;
+	}
+
+	size_t Capacity() const { return buffer_.size(); };
+
+	// Producer only. Returns false, and leaves the queue as it was, if it is full.
+	bool Push(const T &value)
+	{
+		size_t tail = tail_.load(std::memory_order_relaxed);
+		if (tail - head_cache_ == buffer_.size())
+		{
+			head_cache_ = head_.load(std::memory_order_acquire);
+			if (tail - head_cache_ == buffer_.size())
+			{
+				return false;
+			}
+		}
+		buffer_[tail & mask_] = value;
+		tail_.store(tail + 1, std::memory_order_release); // The value is written before the consumer can see it.
+		return true;
+	}
+
+	// Consumer only. Returns false if there is nothing to take.
+	bool Pop(T &value)
+	{
+		size_t head = head_.load(std::memory_order_relaxed);
+		if (head == tail_cache_)
+		{
+			tail_cache_ = tail_.load(std::memory_order_acquire);
+			if (head == tail_cache_)
+			{
+				return false;
+			}
+		}
+		value = buffer_[head & mask_];
+		head_.store(head + 1, std::memory_order_release); // The slot can be written again once the value has been read.
+		return true;
+	}
+
+	// Consumer only. Everything pushed before this was called has been popped.
+	bool Empty() const { return head_.load(std::memory_order_relaxed) == tail_.load(std::memory_order_acquire); };
+
+	// Only while neither thread is using the queue.
+	void Clear()
+	{
+		head_.store(0);
+		tail_.store(0);
+		head_cache_ = 0;
+		tail_cache_ = 0;
+	}
+
+private:
+	std::vector<T> buffer_;
+	size_t mask_;
+	alignas(64) std::atomic<size_t> head_; // Next slot to read, and the consumer's copy of tail_.
+	size_t tail_cache_;
+	alignas(64) std::atomic<size_t> tail_; // Next slot to write, and the producer's copy of head_.
+	size_t head_cache_;
+};
@@ -1,9 +1,72 @@
 #include <SFML/Graphics.hpp>
+#include <cstdlib>
+#include <iostream>
+#include <algorithm>
+#include <utility>
 #include "pathfinding_app.h"
+#include "map_loader.h"
+#include "search_trace.h"
 
-int main()
+// Usage: PathfindingVisualDemo [width height | map_file] [trace_file]
+// The map file can be a MovingAI .map file or a .grid file saved by the demo. A trace file (ending .trace) holds searches
+// recorded by the demo or the benchmark to be replayed, on an empty map of their size if no map is given. A search is
+// only replayed on the map it was made on, the benchmark saves the maps it generates next to its trace.
+int main(int argc, char *argv[])
 {
-	PathfindingApp application;
+	UInt32 width = 26, height = 20;
+	Grid map;
+	std::vector<SearchTrace> traces;
+	std::string last_argument = (argc > 1) ? argv[argc - 1] : "";
+	if (last_argument.size() > 6 && last_argument.compare(last_argument.size() - 6, 6, ".trace") == 0)
+	{
+		if (!LoadSearchTrace(last_argument, traces) || traces.empty())
+		{
+			std::cout << "Could not load any searches from the trace " << last_argument << "." << std::endl;
+			return -1;
+		}
+		argc--;
+		if (argc == 1)
+		{
+			width = traces[0].width;
+			height = traces[0].height;
+		}
+	}
+	if (argc == 2)
+	{
+		if (!LoadMap(argv[1], map))
+		{
+			std::cout << "Could not load the map " << argv[1] << "." << std::endl;
+			return -1;
+		}
+		width = map.Width();
+		height = map.Height();
+	}
+	else if (argc == 3)
+	{
+		width = static_cast<UInt32>(std::strtoul(argv[1], nullptr, 10));
+		height = static_cast<UInt32>(std::strtoul(argv[2], nullptr, 10));
+	}
+	if (width < 2 || height < 1 || width > kMaxGridSize || height > kMaxGridSize)
+	{
+		std::cout << "The map must be between 2x1 and " << kMaxGridSize << "x" << kMaxGridSize << "." << std::endl;
+		return -1;
+	}
+	if (argc != 2)
+	{
+		map = Grid(width, height);
+	}
+	size_t trace_count = traces.size();
+	traces.erase(std::remove_if(traces.begin(), traces.end(), [&](const SearchTrace &trace) { return trace.width != width || trace.height != height; }), traces.end());
+	if (traces.size() != trace_count)
+	{
+		std::cout << "Left out " << trace_count - traces.size() << " searches of the trace made on maps of another size." << std::endl;
+	}
+	if (!traces.empty())
+	{
+		map.SetMovement(traces[0].connectivity, traces[0].corner_cutting); // Starts with the moves the first search was made with.
+	}
+	PathfindingApp application(map);
+	application.SetTraces(std::move(traces));
 	application.Run();
 	return 0;
-}
\ No newline at end of file
+}
@@ -1,29 +1,97 @@
 #include "pathfinding.h"
 #include "pathfinding_app.h"
+#include "map_loader.h"
 #include <cassert>
 #include <stdlib.h>
 #include <vector>
-#include <set>
 #include <algorithm>
 #include <string>
+#include <cmath>
+#include <utility>
 
-PathfindingApp::PathfindingApp() : window(sf::VideoMode(936, 720), "Pathfinding"), start_node(), end_node(), start_selected(false), end_selected(false),
-	path_found(false), current_algorithm(DIJKSTRA), path_length(0), start_x(3), start_y(9), end_x(22), end_y(9), text_dijkstras("Dijkstras algorithm", font, 12),
-	text_astar_manhatten("A* (Manhatten)", font, 12), text_astar_diagonal("A* (Diagonal)", font, 12), speed_multiplier(0)
+// The most costly terrain that costs no more than this, costs loaded from a map file need not match a terrain exactly.
+static const Terrain &TerrainFor(UInt8 cost)
 {
-	graph = InitialiseGrid();
+	int terrain = kTerrainCount - 1;
+	while (terrain > 0 && kTerrains[terrain].cost > cost)
+	{
+		terrain--;
+	}
+	return kTerrains[terrain];
+}
+
+// Where a square is drawn in map coordinates, it is a unit smaller than kSquareSize so the grid lines show between squares.
+static sf::FloatRect SquareRect(UInt32 x, UInt32 y)
+{
+	return sf::FloatRect(x*kSquareSize, y*kSquareSize, kSquareSize - 1.0f, kSquareSize - 1.0f);
+}
+
+// Adds the four corners of a quad to a sf::Quads vertex array.
+static void AddQuad(sf::VertexArray &quads, const sf::FloatRect &rect, sf::Color colour)
+{
+	quads.append(sf::Vertex(sf::Vector2f(rect.left, rect.top), colour));
+	quads.append(sf::Vertex(sf::Vector2f(rect.left + rect.width, rect.top), colour));
+	quads.append(sf::Vertex(sf::Vector2f(rect.left + rect.width, rect.top + rect.height), colour));
+	quads.append(sf::Vertex(sf::Vector2f(rect.left, rect.top + rect.height), colour));
+}
+
+PathfindingApp::PathfindingApp(const Grid &map) : window(sf::VideoMode(936, 720), "Pathfinding"), graph(map), explored_states(map.NodeCount(), UNEXPLORED),
+	layer_quads(sf::Quads), grid_layers_stale(true), path_layer_stale(true), text_layer_stale(true), shown_algorithm(-1), start_selected(false), end_selected(false), path_found(false), stroke_started(false), current_algorithm(DIJKSTRA), cache_hits(0), playback_budget(0), trace_index(0), trace_position(0), path_length(0), algorithm_duration(0),
+	start_x(map.Width() / 8), start_y((map.Height() - 1) / 2), end_x(map.Width() - 1 - map.Width() / 8), end_y((map.Height() - 1) / 2), speed_multiplier(0), nodes_expanded(0), result_cached(false), shown_cache_hits(0), shown_cache_misses(0), brush(kObstacleBrush)
+{
+	components.Build(graph);
+	// A loaded map may have obstacles where the start and end would go.
+	UInt32 start = FreeSquareFrom(graph.Index(start_x, start_y), graph.NodeCount());
+	UInt32 end = FreeSquareFrom(graph.Index(end_x, end_y), start);
+	start_x = graph.X(start);
+	start_y = graph.Y(start);
+	end_x = graph.X(end);
+	end_y = graph.Y(end);
+	// The view starts in the top left corner of the map, the default 26x20 map fits the window exactly.
+	grid_view.reset(sf::FloatRect(0.0f, 0.0f, static_cast<float>(window.getSize().x), static_cast<float>(window.getSize().y)));
 	// Declare and load a font
 	if (!font.loadFromFile("arial.ttf"))
 	{
 		exit(-1);
 	}
+	if (!terrain_layer.create(window.getSize().x, window.getSize().y) || !explored_layer.create(window.getSize().x, window.getSize().y) ||
+		!path_layer.create(window.getSize().x, window.getSize().y) || !text_layer.create(window.getSize().x, window.getSize().y))
+	{
+		exit(-1);
+	}
+	window.setFramerateLimit(60); // The search runs on its own thread, so the window only needs redrawing this often.
 	panels[0].setFillColor(sf::Color(0x00, 0x00, 0x00, 0x77));
-	panels[0].setSize(sf::Vector2f(375.0f, 140.0f));
+	panels[0].setSize(sf::Vector2f(375.0f, 275.0f));
 	panels[0].setPosition(sf::Vector2f(10.0f, 10.f));
 
 	panels[1].setFillColor(sf::Color(0x00, 0x00, 0x00, 0x77));
-	panels[1].setSize(sf::Vector2f(200.0f, 50.0f));
+	panels[1].setSize(sf::Vector2f(200.0f, 5.0f + 15.0f * kAlgorithmCount));
 	panels[1].setPosition(sf::Vector2f(window.getSize().x - 210.0f, 10.0f));
+	for (int i = 0; i < kAlgorithmCount; i++) // Listed in the order of the Algorithm enum.
+	{
+		text_algorithms[i] = sf::Text(AlgorithmName(static_cast<Algorithm>(i)), font, 12);
+		text_algorithms[i].setPosition(sf::Vector2f(window.getSize().x - 200.0f, 10.0f + 15.0f * i));
+	}
+	const std::string instructions[BRUSH_LINE] = {
+		"Drag the RED and GREEN squares",
+		"Use the LEFT and RIGHT mouse buttons to draw/remove obstacles",
+		"Use the <W> and <S> keys to change the algorithm",
+		"Use <A> and <D> keys to change algorithm speed",
+		"Press <SPACE> to clear screen",
+		"Press <RETURN> to run algorithm",
+		"Use the ARROW keys and MOUSE WHEEL to move around the map",
+		std::string("Press <F5> to save the map as ") + kSavedMapFile,
+		"Use <1>-<4> to paint road/grass/mud/water, <0> for obstacles",
+		"Replay a trace with <T>, scrub it with <PAGE UP/DOWN> and <HOME/END>" };
+	for (int i = 0; i < kPanelLineCount; i++)
+	{
+		panel_lines[i] = sf::Text("", font, 12);
+		panel_lines[i].setPosition(sf::Vector2f(15.0f, 10.0f + 15.0f * i));
+		if (i < BRUSH_LINE)
+		{
+			SetPanelLine(i, instructions[i]); // These never change, so they are only laid out once.
+		}
+	}
 }
 
 void PathfindingApp::Run()
@@ -45,72 +113,65 @@ void PathfindingApp::Run()
 					start_selected = false;
 					end_selected = false;
 				}
+				stroke_started = false;
+				MouseEdit(event.mouseButton.x, event.mouseButton.y);
+			}
+			if (event.type == sf::Event::MouseMoved && (sf::Mouse::isButtonPressed(sf::Mouse::Left) || sf::Mouse::isButtonPressed(sf::Mouse::Right)))
+			{
+				MouseEdit(event.mouseMove.x, event.mouseMove.y);
+			}
+			if (event.type == sf::Event::MouseWheelScrolled)
+			{
+				ZoomView(event.mouseWheelScroll.delta > 0 ? 0.8f : 1.25f); // Scrolling up zooms in.
 			}
 			if (event.type == sf::Event::KeyPressed)
 			{
+				if (event.key.code == sf::Keyboard::Left)
+				{
+					PanView(-0.1f, 0.0f); // Moves a tenth of the screen at a time.
+				}
+				if (event.key.code == sf::Keyboard::Right)
+				{
+					PanView(0.1f, 0.0f);
+				}
+				if (event.key.code == sf::Keyboard::Up)
+				{
+					PanView(0.0f, -0.1f);
+				}
+				if (event.key.code == sf::Keyboard::Down)
+				{
+					PanView(0.0f, 0.1f);
+				}
 				if (event.key.code == sf::Keyboard::Space)
 				{
+					StopSearch();
+					StopReplay();
 					ClearGrid();
 					path_found = false;
 					path_length = 0;
 				}
 				if (event.key.code == sf::Keyboard::Return)
 				{
+					StopSearch();
+					StopReplay();
 					ClearGrid();
 					path_found = false;
 					path_length = 0;
-					if (current_algorithm == DIJKSTRA)
-					{
-						std::list<Vertex*> path = DijkstrasAlgorithm();
-						path_line = DrawPath(path);
-					}
-					else
-					{
-						std::list<Vertex*> path = AStarAlgorithm();
-						path_line = DrawPath(path);
-					}
+					RunAlgorithm();
 				}
 				if (event.key.code == sf::Keyboard::W)
 				{
-					switch (current_algorithm)
-					{
-					case A_STAR_DIAGONAL:
-						current_algorithm = DIJKSTRA;
-						break;
-					case A_STAR_MANHATTAN:
-						current_algorithm = A_STAR_DIAGONAL;
-						break;
-					case DIJKSTRA:
-						current_algorithm = A_STAR_MANHATTAN;
-						break;
-					default:
-						assert(false); // ERROR
-						break;
-					}
+					current_algorithm = static_cast<Algorithm>((current_algorithm + kAlgorithmCount - 1) % kAlgorithmCount); // Up the list, wrapping to the bottom.
 				}
 				if (event.key.code == sf::Keyboard::S)
 				{
-					switch (current_algorithm)
-					{
-					case A_STAR_DIAGONAL:
-						current_algorithm = A_STAR_MANHATTAN;
-						break;
-					case A_STAR_MANHATTAN:
-						current_algorithm = DIJKSTRA;
-						break;
-					case DIJKSTRA:
-						current_algorithm = A_STAR_DIAGONAL;
-						break;
-					default:
-						assert(false); // ERROR
-						break;
-					}
+					current_algorithm = static_cast<Algorithm>((current_algorithm + 1) % kAlgorithmCount); // Down the list.
 				}
 				if (event.key.code == sf::Keyboard::D)
 				{
 					if (speed_multiplier != 4)
 					{
-						speed_multiplier++; // This slows the rate of the algorithm by multiplying this factor in the sleep function.
+						speed_multiplier++; // This slows the playback of the algorithm, each closed square is shown for this many pauses.
 					}
 				}
 				if (event.key.code == sf::Keyboard::A)
@@ -120,534 +181,823 @@ void PathfindingApp::Run()
 						speed_multiplier--; // This speeds it up until it reaches realtime.
 					}
 				}
+				if (event.key.code == sf::Keyboard::F5)
+				{
+					SaveGridFile(kSavedMapFile, graph);
+				}
+				if (event.key.code == sf::Keyboard::M)
+				{
+					CycleMovement();
+				}
+				if (event.key.code == sf::Keyboard::R)
+				{
+					ToggleRecording();
+				}
+				if (event.key.code == sf::Keyboard::T)
+				{
+					ReplayNextTrace();
+				}
+				if (trace_index != traces.size()) // Scrubbing the search being replayed.
+				{
+					size_t step = std::max<size_t>(1, traces[trace_index].events.size() / 20);
+					if (event.key.code == sf::Keyboard::PageUp)
+					{
+						SeekTrace(trace_position - std::min(step, trace_position));
+					}
+					if (event.key.code == sf::Keyboard::PageDown)
+					{
+						SeekTrace(trace_position + step);
+					}
+					if (event.key.code == sf::Keyboard::Home)
+					{
+						SeekTrace(0);
+					}
+					if (event.key.code == sf::Keyboard::End)
+					{
+						SeekTrace(traces[trace_index].events.size());
+					}
+				}
+				if (event.key.code == sf::Keyboard::Num0)
+				{
+					brush = kObstacleBrush;
+				}
+				if (event.key.code >= sf::Keyboard::Num1 && event.key.code < sf::Keyboard::Num1 + kTerrainCount)
+				{
+					brush = event.key.code - sf::Keyboard::Num1;
+				}
 			}
 		}
+		float seconds = frame_clock.restart().asSeconds();
+		PlaySearch(seconds);
+		PlayTrace(seconds);
 		Draw();
 	}
 }
 
-Grid PathfindingApp::InitialiseGrid()
+void PathfindingApp::Draw()
 {
-	Grid graph(26, std::vector<Vertex*>(20));
-	// Fills grid:
-	for (UInt32 h = 0; h < 20; h++)
+	UInt32 min_x, min_y, max_x, max_y;
+	VisibleSquares(min_x, min_y, max_x, max_y); // Only the squares on screen are looked at, the map can be much bigger than the window.
+	UpdateGridLayers(min_x, min_y, max_x, max_y); // The grid and path are drawn in map coordinates, so they move with the view.
+
+	// TEXT: only drawn again when a line or the selected algorithm has changed.
+	SetPanelLine(BRUSH_LINE, (brush == kObstacleBrush) ? "Painting: obstacles" : std::string("Painting: ") + kTerrains[brush].name + " (cost " + std::to_string(kTerrains[brush].cost) + ")");
+	if (speed_multiplier == 0)
 	{
-		for (UInt32 w = 0; w < 26; w++)
-		{
-			graph[w][h] = new Vertex(w, h);
-		}
+		SetPanelLine(PAUSE_LINE, "Pause duration: REALTIME");
 	}
-	// Connects horizontal/verticals:
-	for (UInt32 h = 0; h < 20; h++)
+	else
 	{
-		for (UInt32 w = 0; w < 26; w++)
-		{
-			if (w < 25)
-			{
-				Connect(*graph[w][h], *graph[w + 1][h], 1); // Connects horizontals.
-			}
-			if (h < 19)
-			{
-				Connect(*graph[w][h], *graph[w][h + 1], 1); // Connects verticals.
-			}
-		}
+		SetPanelLine(PAUSE_LINE, "Pause duration: " + std::to_string(kPauseIncrement * speed_multiplier) + "ms");
 	}
-	/*/
-	Diagonals were not used in the final release as it was causing some errors with the algorithm, and I dont like the way it cuts corners anyway.
-	// First diagonal.
-	for (UInt32 h = 0; h < 19; h++)
+	SetPanelLine(PATH_LENGTH_LINE, "Path length: " + std::to_string(path_length));
+	std::string str_algorithm_duration = "Algorithm duration: " + std::to_string(algorithm_duration);
+	if (result_cached)
 	{
-		for (UInt32 w = 0; w < 25; w++)
-		{
-			Connect(*graph[w][h], *graph[w+1][h+1], kSquareRoot2);
-		}
+		str_algorithm_duration += " (cached, " + std::to_string(shown_cache_hits) + " hits / " + std::to_string(shown_cache_misses) + " misses)";
+	}
+	else
+	{
+		str_algorithm_duration += " (" + std::to_string(nodes_expanded) + " nodes expanded)"; // Shows how much work each algorithm does for the same path.
 	}
-	// Second diagonol.
-	for (UInt32 h = 0; h < 19; h++)
+	SetPanelLine(DURATION_LINE, str_algorithm_duration);
+	const char *movement_names[3] = { "no corner cutting", "cutting one corner", "cutting both corners" };
+	SetPanelLine(MOVEMENT_LINE, "Press <M> to change the moves, now " +
+		((graph.Movement() == FOUR_CONNECTED) ? std::string("4-connected") : std::string("8-connected, ") + movement_names[graph.CornerRule()]));
+	SetPanelLine(SEARCH_COUNTS_LINE, "Generated: " + std::to_string(search_stats.nodes_generated) + ", decreased: " + std::to_string(search_stats.decrease_keys)
+		+ ", reopened: " + std::to_string(search_stats.reopens) + ", peak open: " + std::to_string(search_stats.peak_open));
+	std::string str_trace = trace_writer.IsOpen() ? std::string("Recording searches to ") + kTraceFile + ", <R> to stop" : std::string("Press <R> to record searches to ") + kTraceFile;
+	if (trace_index != traces.size())
 	{
-		for (UInt32 w = 1; w < 26; w++)
+		const SearchTrace &trace = traces[trace_index];
+		str_trace = "Replaying " + std::to_string(trace_index + 1) + "/" + std::to_string(traces.size()) + ", " + AlgorithmName(trace.algorithm)
+			+ ": event " + std::to_string(trace_position) + "/" + std::to_string(trace.events.size());
+	}
+	if (!trace_message.empty())
+	{
+		str_trace = trace_message;
+	}
+	SetPanelLine(TRACE_LINE, str_trace);
+	SetPanelLine(SEARCH_COSTS_LINE, "Memory: " + std::to_string(search_stats.peak_memory / 1024) + "KB, search: " + std::to_string(search_stats.search_time * 1000)
+		+ "ms, path: " + std::to_string(search_stats.path_time * 1000) + "ms"); // The times include waiting for the playback to catch up.
+	if (shown_algorithm != current_algorithm)
+	{
+		for (int i = 0; i < kAlgorithmCount; i++)
 		{
-			Connect(*graph[w][h], *graph[w - 1][h + 1], kSquareRoot2);
+			text_algorithms[i].setColor(i == current_algorithm ? sf::Color::Red : sf::Color::White); // The selected algorithm is shown in red.
 		}
-	}/*/
-	return graph;
+		shown_algorithm = current_algorithm;
+		text_layer_stale = true;
+	}
+	if (text_layer_stale)
+	{
+		DrawTextLayer();
+	}
+
+	window.setView(window.getDefaultView()); // Every layer covers the window exactly.
+	window.clear(colour_background);
+	window.draw(sf::Sprite(terrain_layer.getTexture()));
+	window.draw(sf::Sprite(explored_layer.getTexture()));
+	window.draw(sf::Sprite(path_layer.getTexture()));
+	window.draw(sf::Sprite(text_layer.getTexture()));
+	window.display();
 }
 
-void PathfindingApp::Draw()
+void PathfindingApp::SetPanelLine(int line, const std::string &string)
+{
+	if (panel_strings[line] != string)
+	{
+		panel_strings[line] = string;
+		panel_lines[line].setString(string);
+		text_layer_stale = true;
+	}
+}
+
+sf::Color PathfindingApp::TerrainColour(UInt32 index) const
+{
+	if (graph.Blocked(index))
+	{
+		return colour_blocked;
+	}
+	const Terrain &terrain = TerrainFor(graph.Cost(index));
+	return (terrain.colour.a == 0) ? colour_background : terrain.colour;
+}
+
+sf::Color PathfindingApp::ExploredColour(UInt32 index) const
 {
-	window.clear(sf::Color(0xF9, 0xF9, 0xF9));
-	for (int y = 0; y < 20; y++)
+	switch (explored_states[index])
 	{
-		for (int x = 0; x < 26; x++)
+	case IN_OPEN_SET:
+		return colour_open_set;
+	case IN_CLOSED_SET:
+		return colour_closed_set;
+	default:
+		return sf::Color::Transparent;
+	}
+}
+
+// The grid layers are drawn from scratch when the view moves or the grid is cleared. Otherwise only the squares that
+// changed are drawn, without blending so they replace what was there, and the path layer only when the path, start or
+// end has changed. So a frame costs about the same however much of the map the search has covered.
+void PathfindingApp::UpdateGridLayers(UInt32 min_x, UInt32 min_y, UInt32 max_x, UInt32 max_y)
+{
+	if (grid_layers_stale || grid_view.getCenter() != layer_view_centre || grid_view.getSize() != layer_view_size)
+	{
+		layer_view_centre = grid_view.getCenter();
+		layer_view_size = grid_view.getSize();
+		terrain_layer.setView(grid_view);
+		explored_layer.setView(grid_view);
+		path_layer.setView(grid_view);
+		layer_quads.clear();
+		// The first quad is behind every square, it shows through the gaps between them as the grid lines.
+		AddQuad(layer_quads, sf::FloatRect(min_x*kSquareSize - 1.0f, min_y*kSquareSize - 1.0f, (max_x - min_x)*kSquareSize + 1.0f, (max_y - min_y)*kSquareSize + 1.0f), colour_grid_lines);
+		for (UInt32 y = min_y; y < max_y; y++)
 		{
-			squares[x][y].setPosition(sf::Vector2f(x*36.0f, y*36.0f));
-			squares[x][y].setSize(sf::Vector2f(35.0f, 35.0f));
-			squares[x][y].setOutlineThickness(1.0f);
-			squares[x][y].setOutlineColor(sf::Color(0x44, 0x44, 0x44, 0x66));
-			if (x == start_x && y == start_y)
+			for (UInt32 x = min_x; x < max_x; x++)
 			{
-				squares[x][y].setFillColor(sf::Color::Green);
-				start_node = graph[x][y];
+				AddQuad(layer_quads, SquareRect(x, y), TerrainColour(graph.Index(x, y)));
 			}
-			else if (x == end_x && y == end_y)
-			{
-				squares[x][y].setFillColor(sf::Color::Red);
-				end_node = graph[x][y];
-			}
-			else if (squares[x][y].getFillColor() != colour_blocked)
+		}
+		terrain_layer.clear(colour_background);
+		terrain_layer.draw(layer_quads);
+		terrain_layer.display();
+		layer_quads.clear();
+		for (UInt32 y = min_y; y < max_y; y++)
+		{
+			for (UInt32 x = min_x; x < max_x; x++)
 			{
-				if ((squares[x][y].getFillColor() != colour_open_set) && (squares[x][y].getFillColor() != colour_closed_set))
+				sf::Color colour = ExploredColour(graph.Index(x, y));
+				if (colour.a != 0)
 				{
-					squares[x][y].setFillColor(sf::Color::Transparent);
+					AddQuad(layer_quads, SquareRect(x, y), colour);
 				}
 			}
-			if (sf::Mouse::isButtonPressed(sf::Mouse::Right))
+		}
+		explored_layer.clear(sf::Color::Transparent);
+		explored_layer.draw(layer_quads, sf::BlendNone); // The layer is see through, the colours are blended when it is drawn on the terrain.
+		explored_layer.display();
+		grid_layers_stale = false;
+		path_layer_stale = true;
+	}
+	else if (!changed_squares.empty())
+	{
+		layer_quads.clear();
+		for (UInt32 index : changed_squares)
+		{
+			UInt32 x = graph.X(index), y = graph.Y(index);
+			if (x >= min_x && x < max_x && y >= min_y && y < max_y)
 			{
-				if ((sf::Mouse::getPosition(window).x <= squares[x][y].getPosition().x + squares[x][y].getLocalBounds().width) && (sf::Mouse::getPosition(window).x >= squares[x][y].getPosition().x))
-				{
-					if ((sf::Mouse::getPosition(window).y <= squares[x][y].getPosition().y + squares[x][y].getLocalBounds().height) && (sf::Mouse::getPosition(window).y >= squares[x][y].getPosition().y))
-					{
-						if (squares[x][y].getFillColor() == colour_blocked)
-						{
-							squares[x][y].setFillColor(sf::Color::Transparent);
-							graph[x][y]->blocked = false;
-						}
-					}
-				}
+				AddQuad(layer_quads, SquareRect(x, y), TerrainColour(index));
 			}
-			if (sf::Mouse::isButtonPressed(sf::Mouse::Left))
+		}
+		terrain_layer.draw(layer_quads, sf::BlendNone);
+		terrain_layer.display();
+		size_t quad = 0;
+		for (UInt32 index : changed_squares) // The same squares again, in the same order.
+		{
+			UInt32 x = graph.X(index), y = graph.Y(index);
+			if (x >= min_x && x < max_x && y >= min_y && y < max_y)
 			{
-				if ((sf::Mouse::getPosition(window).x <= squares[x][y].getPosition().x + squares[x][y].getLocalBounds().width) && (sf::Mouse::getPosition(window).x >= squares[x][y].getPosition().x))
+				sf::Color colour = ExploredColour(index);
+				for (int corner = 0; corner < 4; corner++)
 				{
-					if ((sf::Mouse::getPosition(window).y <= squares[x][y].getPosition().y + squares[x][y].getLocalBounds().height) && (sf::Mouse::getPosition(window).y >= squares[x][y].getPosition().y))
-					{
-						if (start_selected)
-						{
-							if (squares[x][y].getFillColor() == sf::Color::Transparent)
-							{
-								start_x = x;
-								start_y = y;
-								start_node = graph[x][y];
-							}
-						}
-						else if (end_selected)
-						{
-							if (squares[x][y].getFillColor() == sf::Color::Transparent)
-							{
-								end_x = x;
-								end_y = y;
-								end_node = graph[x][y];
-							}
-						}
-						else
-						{
-							if (squares[x][y].getFillColor() == sf::Color::Transparent)
-							{
-								squares[x][y].setFillColor(colour_blocked);
-								graph[x][y]->blocked = true;
-							}
-							else if (squares[x][y].getFillColor() == sf::Color::Green)
-							{
-								start_selected = true;
-							}
-							else if (squares[x][y].getFillColor() == sf::Color::Red)
-							{
-								end_selected = true;
-							}
-						}
-					}
+					layer_quads[quad++].color = colour;
 				}
 			}
-			window.draw(squares[x][y]);
 		}
+		explored_layer.draw(layer_quads, sf::BlendNone); // Transparent squares wipe out what was there.
+		explored_layer.display();
 	}
-	if (path_found)
+	changed_squares.clear();
+	if (path_layer_stale)
 	{
-		for (sf::RectangleShape line_segment : path_line)
+		path_layer.clear(sf::Color::Transparent);
+		layer_quads.clear();
+		AddQuad(layer_quads, SquareRect(start_x, start_y), sf::Color::Green);
+		AddQuad(layer_quads, SquareRect(end_x, end_y), sf::Color::Red);
+		path_layer.draw(layer_quads);
+		if (path_found)
 		{
-			window.draw(line_segment);
+			for (const sf::RectangleShape &line_segment : path_line)
+			{
+				path_layer.draw(line_segment);
+			}
 		}
+		path_layer.display();
+		path_layer_stale = false;
 	}
-	for (auto panel : panels)
+}
+
+void PathfindingApp::DrawTextLayer()
+{
+	text_layer.clear(sf::Color::Transparent);
+	for (const sf::RectangleShape &panel : panels)
 	{
-		window.draw(panel);
+		text_layer.draw(panel);
 	}
-
-	// TEXT:
-	str_path_length = "Path length: ";
-	str_path_length += std::to_string(path_length); // This adds the number to the strin
-	str_pause_duration = "Pause duration: ";
-	str_algorithm_duration = "Algorithm duration: ";
-	str_algorithm_duration += std::to_string(algorithm_duration);
-	if (speed_multiplier == 0)
+	for (const sf::Text &panel_line : panel_lines)
 	{
-		str_pause_duration = "Pause duration: REALTIME";
+		text_layer.draw(panel_line);
 	}
-	else
+	for (const sf::Text &text_algorithm : text_algorithms)
 	{
-		str_pause_duration += std::to_string(kPauseIncrement * speed_multiplier) + "ms";
-	}
-	sf::Text text_instruction1("Drag the RED and GREEN squares", font, 12);
-	sf::Text text_instruction2("Use the LEFT and RIGHT mouse buttons to draw/remove obstacles", font, 12);
-	sf::Text text_instruction3("Use the <W> and <S> keys to change the algorithm", font, 12);
-	sf::Text text_instruction4("Use <A> and <D> keys to change algorithm speed", font, 12);
-	sf::Text text_instruction5("Press <SPACE> to clear screen", font, 12);
-	sf::Text text_instruction6("Press <RETURN> to run algorithm", font, 12);
-	sf::Text text_pause_duration(str_pause_duration, font, 12);
-	sf::Text text_path_length(str_path_length, font, 12);
-	sf::Text text_algorithm_duration(str_algorithm_duration, font, 12);
-	text_instruction1.setPosition(sf::Vector2f(15.0, 10.0f));
-	text_instruction2.setPosition(sf::Vector2f(15.0f, 25.0f));
-	text_instruction3.setPosition(sf::Vector2f(15.0f, 40.0f));
-	text_instruction4.setPosition(sf::Vector2f(15.0f, 55.0f));
-	text_instruction5.setPosition(sf::Vector2f(15.0f, 70.0f));
-	text_instruction6.setPosition(sf::Vector2f(15.0f, 85.0f));
-	text_pause_duration.setPosition(sf::Vector2f(15.0f, 100.0f));
-	text_path_length.setPosition(sf::Vector2f(15.0f, 115.0f));
-	text_algorithm_duration.setPosition(sf::Vector2f(15.0f, 130.0f));
-	text_dijkstras.setPosition(sf::Vector2f(window.getSize().x - 200.0f, 40.0f));
-	text_astar_diagonal.setPosition(sf::Vector2f(window.getSize().x - 200.0f, 10.0f));
-	text_astar_manhatten.setPosition(sf::Vector2f(window.getSize().x - 200.0f, 25.0f));
-	switch (current_algorithm)
-	{
-		case A_STAR_DIAGONAL:
-			text_astar_diagonal.setColor(sf::Color::Red);
-			text_astar_manhatten.setColor(sf::Color::White);
-			text_dijkstras.setColor(sf::Color::White);
-			break;
-		case A_STAR_MANHATTAN:
-			text_astar_diagonal.setColor(sf::Color::White);
-			text_astar_manhatten.setColor(sf::Color::Red);
-			text_dijkstras.setColor(sf::Color::White);
-			break;
-		case DIJKSTRA:
-			text_astar_diagonal.setColor(sf::Color::White);
-			text_astar_manhatten.setColor(sf::Color::White);
-			text_dijkstras.setColor(sf::Color::Red);
-			break;
-		default:
-			assert(false); // ERROR
-			break;
-	}
-
-	window.draw(text_instruction1);
-	window.draw(text_instruction2);
-	window.draw(text_instruction3);
-	window.draw(text_instruction4);
-	window.draw(text_instruction5);
-	window.draw(text_instruction6);
-	window.draw(text_path_length);
-	window.draw(text_algorithm_duration);
-	window.draw(text_pause_duration);
-	window.draw(text_astar_diagonal);
-	window.draw(text_astar_manhatten);
-	window.draw(text_dijkstras);
-	window.display();
+		text_layer.draw(text_algorithm);
+	}
+	text_layer.display();
+	text_layer_stale = false;
 }
 
-void PathfindingApp::ClearGrid()
+// Works out the range of squares that are inside the view, the max values are one past the last visible square.
+void PathfindingApp::VisibleSquares(UInt32 &min_x, UInt32 &min_y, UInt32 &max_x, UInt32 &max_y) const
+{
+	sf::Vector2f top_left = grid_view.getCenter() - grid_view.getSize() * 0.5f;
+	sf::Vector2f bottom_right = grid_view.getCenter() + grid_view.getSize() * 0.5f;
+	min_x = static_cast<UInt32>(std::max(0.0f, std::floor(top_left.x / kSquareSize)));
+	min_y = static_cast<UInt32>(std::max(0.0f, std::floor(top_left.y / kSquareSize)));
+	max_x = static_cast<UInt32>(std::max(0.0f, std::min(static_cast<float>(graph.Width()), std::ceil(bottom_right.x / kSquareSize))));
+	max_y = static_cast<UInt32>(std::max(0.0f, std::min(static_cast<float>(graph.Height()), std::ceil(bottom_right.y / kSquareSize))));
+	min_x = std::min(min_x, max_x);
+	min_y = std::min(min_y, max_y);
+}
+
+// Factor is the change in the size of the view, less than 1 zooms in.
+void PathfindingApp::ZoomView(float factor)
 {
-	for (int y = 0; y < 20; y++)
+	sf::Vector2f size = grid_view.getSize() * factor;
+	float window_width = static_cast<float>(window.getSize().x);
+	float max_width = kMaxVisibleSquares * kSquareSize; // Zooming out is limited as every visible square is drawn again when the view moves.
+	if (size.x < window_width * 0.25f || size.x > max_width)
 	{
-		for (int x = 0; x < 26; x++)
+		return;
+	}
+	grid_view.setSize(size);
+	PanView(0.0f, 0.0f); // Keeps the view over the map.
+}
+
+// Moves the view by a fraction of its size, the centre of the view is kept inside the map.
+void PathfindingApp::PanView(float x_fraction, float y_fraction)
+{
+	sf::Vector2f centre = grid_view.getCenter();
+	centre.x += grid_view.getSize().x * x_fraction;
+	centre.y += grid_view.getSize().y * y_fraction;
+	centre.x = std::max(0.0f, std::min(centre.x, graph.Width() * kSquareSize));
+	centre.y = std::max(0.0f, std::min(centre.y, graph.Height() * kSquareSize));
+	grid_view.setCenter(centre);
+}
+
+// The first square at or after index (in reading order, wrapping around) that is not blocked and is not other.
+// Returns index if there isn't one.
+UInt32 PathfindingApp::FreeSquareFrom(UInt32 index, UInt32 other) const
+{
+	for (UInt32 i = 0; i < graph.NodeCount(); i++)
+	{
+		UInt32 candidate = (index + i) % graph.NodeCount();
+		if (!graph.Blocked(candidate) && candidate != other)
 		{
-			if (squares[x][y].getFillColor() != colour_blocked)
-			{
-				squares[x][y].setFillColor(sf::Color::Transparent);
-			}
+			return candidate;
 		}
 	}
+	return index;
 }
 
-std::list<Vertex*> PathfindingApp::DijkstrasAlgorithm()
+bool PathfindingApp::EditSquare(UInt32 index, bool blocked, UInt8 cost)
 {
-	sf::Clock timer; // A clock used to measure the time that the algorithm has been running.
-	// compare_distances is a functor that orders the set by distance, rather than address:
-	std::set<Vertex*, compare_distances> open_set; // Ordered from lowest distance/f-cost.
-	std::set<Vertex*> closed_set;
+	if (graph.Blocked(index) == blocked && graph.Cost(index) == cost)
+	{
+		return false;
+	}
+	UInt64 previous_version = graph.Version();
+	if (graph.Blocked(index) != blocked)
+	{
+		graph.SetBlocked(index, blocked);
+	}
+	if (graph.Cost(index) != cost)
+	{
+		graph.SetCost(index, cost);
+	}
+	SquareChanged(index, previous_version);
+	return true;
+}
+
+void PathfindingApp::SquareChanged(UInt32 index, UInt64 previous_version)
+{
+	changed_squares.push_back(index); // Drawn again in the next frame.
+	hierarchy.CellChanged(graph, index); // Only rebuilds the clusters around this square.
+	replanner.CellChanged(graph, index);
+	path_cache.CellChanged(graph, index, previous_version); // Only forgets the paths whose searches reached this square.
+	components.CellChanged(graph, index);
+}
+
+bool PathfindingApp::SquareAt(int pixel_x, int pixel_y, UInt32 &x, UInt32 &y) const
+{
+	sf::Vector2f position = window.mapPixelToCoords(sf::Vector2i(pixel_x, pixel_y), grid_view);
+	if (position.x < 0.0f || position.y < 0.0f)
+	{
+		return false;
+	}
+	x = static_cast<UInt32>(position.x / kSquareSize);
+	y = static_cast<UInt32>(position.y / kSquareSize);
+	return x < graph.Width() && y < graph.Height();
+}
 
-	float current_distance = 0;
-	Vertex* current_node;
-	Vertex* next_node; // Vertex pointer to represent the next node to add.
-	start_node->g_cost = current_distance; // Distance to start node is 0.
-	start_node->f_cost = start_node->g_cost; // For dijkstras algorithm f-cost = g-cost as h-cost is 0. (just represents distance from start node)
-	start_node->parent = nullptr; // Start node has no parent.
-	bool no_path = false;
+// Mouse events can be many squares apart when it moves quickly, so every square on the line from the last one it was
+// over is edited, and a stroke leaves no gaps.
+void PathfindingApp::MouseEdit(int pixel_x, int pixel_y)
+{
+	UInt32 x, y;
+	if (!SquareAt(pixel_x, pixel_y, x, y))
+	{
+		stroke_started = false;
+		return;
+	}
+	if (!stroke_started)
+	{
+		EditAt(x, y);
+	}
+	else
+	{
+		float x_difference = static_cast<float>(x) - static_cast<float>(stroke_x);
+		float y_difference = static_cast<float>(y) - static_cast<float>(stroke_y);
+		int steps = static_cast<int>(std::max(std::abs(x_difference), std::abs(y_difference)));
+		for (int step = 1; step <= steps; step++)
+		{
+			float fraction = static_cast<float>(step) / steps;
+			EditAt(static_cast<UInt32>(std::lround(stroke_x + x_difference * fraction)), static_cast<UInt32>(std::lround(stroke_y + y_difference * fraction)));
+		}
+	}
+	stroke_started = true;
+	stroke_x = x;
+	stroke_y = y;
+}
 
-	open_set.insert(start_node);
-	squares[start_node->coordinates_.x][start_node->coordinates_.y].setFillColor(colour_open_set); // This colours the square representing this node.
-	while (no_path == false)
+void PathfindingApp::EditAt(UInt32 x, UInt32 y)
+{
+	UInt32 index = graph.Index(x, y);
+	UInt32 start = graph.Index(start_x, start_y), end = graph.Index(end_x, end_y);
+	bool editable = !search_worker.Running(); // The search reads the grid, so it can only be drawn on between searches.
+	if (editable && sf::Mouse::isButtonPressed(sf::Mouse::Right))
+	{
+		EditSquare(index, false, 1); // Back to road.
+	}
+	if (sf::Mouse::isButtonPressed(sf::Mouse::Left))
 	{
-		current_node = *open_set.begin(); // This gives the node with the lowest f-cost by selecting the first item in the set.
-		current_distance = current_node->g_cost; // g-cost is the distance from the start node.
-		if (current_node == end_node)
+		bool free = !graph.Blocked(index) && explored_states[index] == UNEXPLORED; // The start and end can only be moved on to these.
+		if (start_selected)
 		{
-			break; // We have found a path.
+			if (free && index != end)
+			{
+				start_x = x;
+				start_y = y;
+				path_layer_stale = true;
+			}
 		}
-		open_set.erase(open_set.begin());
-		closed_set.insert(current_node); // Mark current node as visited/add it to the closed set.
-		squares[current_node->coordinates_.x][current_node->coordinates_.y].setFillColor(colour_closed_set); // Change the nodes colour.
-		for (auto connection_ : current_node->connections) // Loop through all the vertex connections (neigbours).
+		else if (end_selected)
 		{
-			next_node = connection_.node; // The node that this connection leads to.
-			// If this node has already been added to the closed set, OR its blocked:
-			if ((closed_set.find(next_node) != closed_set.end()) || (next_node->blocked == true))
+			if (free && index != start)
 			{
-				continue; // Move on to the next node.
+				end_x = x;
+				end_y = y;
+				path_layer_stale = true;
 			}
-			else
+		}
+		else if (index == start)
+		{
+			start_selected = true;
+		}
+		else if (index == end)
+		{
+			end_selected = true;
+		}
+		else if (brush == kObstacleBrush)
+		{
+			if (editable && free)
 			{
-				float total_distance = current_distance + connection_.distance; // Calculate total distance to this node through the current_node.
-				if (open_set.find(next_node) == open_set.end()) // If the node is NOT in the open set.
-				{
-					// Update g/h/f costs and then add to the open set
-					squares[next_node->coordinates_.x][next_node->coordinates_.y].setFillColor(colour_open_set); // This should colour the square.
-					next_node->g_cost = total_distance; // Write the distance to it through this node.
-					next_node->f_cost = next_node->g_cost; // For dijkstras algorithm f_cost = g_cost as h_cost is 0.
-					next_node->parent = current_node; // Set this node as it's parent
-					open_set.insert(next_node); // Add this node to the open set.
-				}
-				else if (total_distance < next_node->g_cost) // If this node IS in the open set and if this path gives a shorter distance:
-				{
-					next_node->g_cost = total_distance; // Relax the distance.
-					next_node->f_cost = next_node->g_cost;
-					next_node->parent = current_node; // Set this node as it's parent
-				}
+				EditSquare(index, true, graph.Cost(index));
 			}
 		}
-		if (open_set.empty())
+		else if (editable && !graph.Blocked(index))
 		{
-			no_path = true;
+			EditSquare(index, false, kTerrains[brush].cost);
 		}
-		sf::sleep(sf::milliseconds(kPauseIncrement*speed_multiplier)); // Wait for this long.
-		Draw(); // Draw the progress for each iteration.
 	}
-	// Trace path.
-	std::list<Vertex*> path;
-	Vertex *path_node = end_node; // Current node being added to the path.
-	if (no_path == false)
+}
+
+void PathfindingApp::CycleMovement()
+{
+	StopSearch();
+	if (graph.Movement() == FOUR_CONNECTED)
+	{
+		graph.SetMovement(EIGHT_CONNECTED, NO_CORNER_CUTTING);
+	}
+	else if (graph.CornerRule() != CUT_BOTH_CORNERS)
 	{
-		while (path_node != start_node)
-		{
-			path.push_front(path_node); // Add to path.
-			path_node = path_node->parent; // Next node to add.
-		}
-		path.push_front(start_node);
-		path_found = true;
-		path_length = end_node->g_cost; // Path length is the final length to the end node.
+		graph.SetMovement(EIGHT_CONNECTED, static_cast<CornerCutting>(graph.CornerRule() + 1));
 	}
 	else
 	{
-		path_found = false;
+		graph.SetMovement(FOUR_CONNECTED);
 	}
-	algorithm_duration = timer.getElapsedTime().asSeconds(); // Set this application variable
-	return path;
+	// Every distance can change, so what is kept up to date square by square starts again. The landmark tables see the
+	// grid's version change and do the same. So does the path cache, which is cleared straight away so that no path found
+	// with the old moves outlives it.
+	path_cache.Clear();
+	components.Build(graph);
+	if (hierarchy.Built())
+	{
+		hierarchy.Build(graph);
+	}
+	replanner.Reset();
 }
 
-std::list<Vertex*> PathfindingApp::AStarAlgorithm()
+void PathfindingApp::ClearGrid()
 {
-	sf::Clock timer; // A clock used to measure the time that the algorithm has been running.
-	// compare_distances is a functor that orders the set by distance/ f-cost, rather than address.
-	std::set<Vertex*, compare_distances> open_set;
-	std::set<Vertex*> closed_set;
+	for (UInt32 index : explored_squares)
+	{
+		explored_states[index] = UNEXPLORED;
+	}
+	explored_squares.clear();
+	grid_layers_stale = true; // Quicker than going through every square that was coloured.
+}
 
-	float current_distance = 0; // Distance to start node is 0.
-	Vertex* current_node;
-	Vertex* next_node; // To hold a pointer to a node that this connects to.
-	start_node->g_cost = current_distance; 
-	if (current_algorithm == A_STAR_MANHATTAN) // This is to determine what heuristic to use.
+void PathfindingApp::RunAlgorithm()
+{
+	StopSearch();
+	UInt32 start = graph.Index(start_x, start_y), end = graph.Index(end_x, end_y);
+	cache_hits = path_cache.Hits();
+	playback_budget = 0;
+	if (!components.Connected(start, end))
 	{
-		start_node->h_cost = ManhattanDistance(start_node);
+		ShowResult(SearchResult()); // The end can not be reached, so there is nothing to search.
+		return;
 	}
-	else if (current_algorithm == A_STAR_DIAGONAL)
+	Algorithm algorithm = current_algorithm;
+	bool recording = trace_writer.IsOpen();
+	search_worker.Start([this, start, end, algorithm, recording](SearchObserver *observer)
+	{
+		if (!recording)
+		{
+			return RunSearch(algorithm, start, end, observer);
+		}
+		trace_writer.PassOn(observer); // Recorded on its way to being drawn.
+		trace_writer.BeginSearch(graph, algorithm, start, end);
+		SearchResult result = RunSearch(algorithm, start, end, &trace_writer);
+		trace_writer.EndSearch(result);
+		return result;
+	});
+}
+
+void PathfindingApp::StopSearch()
+{
+	if (search_worker.Running())
 	{
-		start_node->h_cost = DiagonalDistance(start_node);
+		search_worker.Cancel();
+		search_worker.TakeResult(); // The search stops at the next node it closes, the result is not shown.
 	}
-	start_node->f_cost = start_node->g_cost + start_node->h_cost;
-	start_node->parent = nullptr; // Start node has no parent
-	bool no_path = false;
+}
 
-	open_set.insert(start_node);
-	squares[start_node->coordinates_.x][start_node->coordinates_.y].setFillColor(colour_open_set);
-	while (no_path == false)
+void PathfindingApp::PlaySearch(float seconds)
+{
+	if (!search_worker.Running())
 	{
-		current_node = *open_set.begin(); // This gives the node with the lowest f-cost as the set is sorted by distance/f-cost.
-		current_distance = current_node->g_cost;
-		if (current_node == end_node)
+		return;
+	}
+	if (speed_multiplier != 0)
+	{
+		playback_budget += seconds * 1000.0f / (kPauseIncrement * speed_multiplier); // One closed square every kPauseIncrement * speed_multiplier ms.
+	}
+	UInt32 node;
+	bool closed;
+	size_t events_left = SearchWorker::kQueueCapacity; // At REALTIME the worker could keep the queue full forever, so a frame takes at most a queue full.
+	while ((speed_multiplier == 0 || playback_budget >= 1.0f) && events_left-- > 0 && search_worker.NextEvent(node, closed))
+	{
+		if (closed)
+		{
+			NodeClosed(node);
+			playback_budget -= 1.0f;
+		}
+		else
 		{
-			break; // We have found a path.
+			NodeOpened(node);
 		}
-		open_set.erase(open_set.begin());
-		closed_set.insert(current_node); // Mark current node as visited/add it to the closed set.
-		squares[current_node->coordinates_.x][current_node->coordinates_.y].setFillColor(colour_closed_set);
+	}
+	playback_budget = std::max(0.0f, std::min(playback_budget, 1.0f)); // A slow search does not save up time to play faster later.
+	if (search_worker.Finished())
+	{
+		ShowResult(search_worker.TakeResult());
+	}
+}
 
-		for (auto connection_ : current_node->connections) // Loop through all the vertex connections (neigbours).
+void PathfindingApp::SetTraces(std::vector<SearchTrace> searches)
+{
+	traces = std::move(searches);
+	trace_index = traces.size();
+	trace_position = 0;
+}
+
+// Runs on the worker thread. Nothing it uses may be changed until the worker's result has been taken.
+SearchResult PathfindingApp::RunSearch(Algorithm algorithm, UInt32 start, UInt32 end, SearchObserver *observer)
+{
+	if (algorithm == HIERARCHICAL_A_STAR)
+	{
+		return hierarchy.FindPath(graph, start, end, search_state, observer); // Keeps the abstraction between runs, the squares coloured are the cluster entrances.
+	}
+	if (algorithm == A_STAR_LANDMARKS)
+	{
+		if (!landmarks.UpToDate(graph))
 		{
-			next_node = connection_.node; // Get the node that this connection leads to
-			// If this node has already been added to the closed set, OR its blocked:
-			if ((closed_set.find(next_node) != closed_set.end()) || (next_node->blocked == true))
-			{
-				continue; // Move on to the next node.
-			}
-			else
-			{
-				float total_distance = current_distance + connection_.distance; // Calculate total distance to this node through the current_node.
-				if (open_set.find(next_node) == open_set.end()) // If the node is NOT already in the open set.
-				{
-					// Update g/h/f costs then add it to the open set:
-					squares[next_node->coordinates_.x][next_node->coordinates_.y].setFillColor(colour_open_set); // This should colour the square.
-					next_node->g_cost = total_distance;
-					if (current_algorithm == A_STAR_MANHATTAN)
-					{
-						next_node->h_cost = ManhattanDistance(next_node); // Estimated distance to end node from this node.
-					}
-					else if (current_algorithm == A_STAR_DIAGONAL)
-					{
-						next_node->h_cost = DiagonalDistance(next_node);
-					}
-					next_node->f_cost = next_node->g_cost + next_node->h_cost;
-					next_node->parent = current_node; // Set this node as it's parent
-					open_set.insert(next_node); // Add this node to the open set.
-				}
-				else if (total_distance < next_node->f_cost) // If this node IS in the open set and this path gives a shorter distance:
-				{
-					next_node->g_cost = total_distance; // Relax the distance.
-					next_node->f_cost = next_node->g_cost + next_node->h_cost; // Recalculate f-cost.
-					next_node->parent = current_node; // Set this node as it's parent
-				}
-			}
+			landmarks.Build(graph);
 		}
-		if (open_set.empty())
+		return LandmarkAStar(graph, start, end, landmarks, search_state, observer);
+	}
+	if (algorithm == D_STAR_LITE)
+	{
+		return replanner.FindPath(graph, start, end, observer); // Only the squares it had to expand again are coloured.
+	}
+	return path_cache.FindPath(graph, start, end, algorithm, search_state, observer); // The observer passes the progress on to be drawn.
+}
+
+void PathfindingApp::ToggleRecording()
+{
+	StopSearch(); // The worker writes to the trace while a search runs.
+	trace_message.clear();
+	if (trace_writer.IsOpen())
+	{
+		if (!trace_writer.Close())
+		{
+			trace_message = std::string("Could not write all of ") + kTraceFile + ", press <R> to record again";
+		}
+	}
+	else if (!trace_writer.Open(kTraceFile))
+	{
+		trace_writer.Close(); // It may have been opened but not written to.
+		trace_message = std::string("Could not write ") + kTraceFile + ", press <R> to try again";
+	}
+}
+
+void PathfindingApp::ReplayNextTrace()
+{
+	if (traces.empty())
+	{
+		return;
+	}
+	StopSearch();
+	trace_message.clear();
+	// A search is only shown on the map it was made on, with the same moves, anywhere else it would not be what happened.
+	UInt64 grid_hash = graph.ContentHash();
+	bool same_map = false, found = false;
+	size_t next = trace_index;
+	for (size_t tried = 0; tried < traces.size() && !found; tried++)
+	{
+		next = (next + 1 < traces.size()) ? next + 1 : 0; // Wraps back to the first, and starts there when none is being replayed.
+		const SearchTrace &trace = traces[next];
+		same_map = same_map || (trace.grid_hash == grid_hash);
+		found = (trace.grid_hash == grid_hash && trace.connectivity == graph.Movement() && trace.corner_cutting == graph.CornerRule());
+	}
+	if (!found)
+	{
+		StopReplay();
+		trace_message = same_map ? "The trace's searches on this map used other moves, change them with <M>" : "None of the trace's searches were made on this map as it is now";
+		return;
+	}
+	trace_index = next;
+	const SearchTrace &trace = traces[trace_index];
+	ClearGrid();
+	path_found = false;
+	path_length = 0;
+	start_x = graph.X(trace.start);
+	start_y = graph.Y(trace.start);
+	end_x = graph.X(trace.end);
+	end_y = graph.Y(trace.end);
+	path_layer_stale = true;
+	cache_hits = path_cache.Hits();
+	playback_budget = 0;
+	trace_position = 0;
+	SeekTrace(0); // A search with no events, one from the path cache, is shown at once.
+}
+
+void PathfindingApp::StopReplay()
+{
+	trace_index = traces.size();
+}
+
+void PathfindingApp::PlayTrace(float seconds)
+{
+	if (trace_index == traces.size() || trace_position == traces[trace_index].events.size())
+	{
+		return;
+	}
+	const std::vector<TraceEvent> &events = traces[trace_index].events;
+	if (speed_multiplier != 0)
+	{
+		playback_budget += seconds * 1000.0f / (kPauseIncrement * speed_multiplier); // The same pace as a search that is running.
+	}
+	size_t position = trace_position;
+	size_t events_left = SearchWorker::kQueueCapacity; // At REALTIME a frame shows as many events as it would from the worker.
+	while ((speed_multiplier == 0 || playback_budget >= 1.0f) && events_left-- > 0 && position < events.size())
+	{
+		if (events[position].kind == TRACE_CLOSED)
 		{
-			no_path = true;
+			playback_budget -= 1.0f;
 		}
-		sf::sleep(sf::milliseconds(kPauseIncrement*speed_multiplier)); // Wait for this long.
-		Draw(); // Draw the progress for each iteration.
+		position++;
+	}
+	playback_budget = std::max(0.0f, std::min(playback_budget, 1.0f));
+	SeekTrace(position);
+}
+
+// Going back starts again from the first event, the explored squares are not kept for every position.
+void PathfindingApp::SeekTrace(size_t position)
+{
+	const SearchTrace &trace = traces[trace_index];
+	position = std::min(position, trace.events.size());
+	if (position < trace_position)
+	{
+		ClearGrid();
+		trace_position = 0;
 	}
-	// Trace path.
-	std::list<Vertex*> path;
-	Vertex *path_node = end_node; // Current node being added to the path.
-	if (no_path == false)
+	for (; trace_position < position; trace_position++)
 	{
-		while (path_node != start_node)
+		const TraceEvent &event = trace.events[trace_position];
+		if (event.kind == TRACE_CLOSED)
 		{
-			path.push_front(path_node); // Add to path.
-			path_node = path_node->parent; // Next node to add.
+			NodeClosed(event.node);
+		}
+		else
+		{
+			NodeOpened(event.node); // Relaxing a node leaves it in the open set.
 		}
-		path.push_front(start_node);
-		path_found = true;
-		path_length = end_node->g_cost; // Path length is the final length to the end node.
 	}
-	else
+	if (trace_position == trace.events.size())
+	{
+		ShowResult(trace.result);
+	}
+	else if (path_found) // Scrubbed back from the end.
 	{
 		path_found = false;
+		path_layer_stale = true;
 	}
-	algorithm_duration = timer.getElapsedTime().asSeconds(); // Set this application variable
-	return path;
 }
 
-float PathfindingApp::DiagonalDistance(Vertex * node) // Heuristic (estimate of distance to endnode)
+void PathfindingApp::ShowResult(const SearchResult &result)
+{
+	result_cached = (path_cache.Hits() != cache_hits);
+	shown_cache_hits = path_cache.Hits();
+	shown_cache_misses = path_cache.Misses();
+	path_found = result.path_found;
+	path_length = result.path_length;
+	algorithm_duration = result.duration; // Set this application variable
+	nodes_expanded = result.nodes_expanded;
+	search_stats = result.stats;
+	path_line = DrawPath(result.path);
+	path_layer_stale = true;
+}
+
+void PathfindingApp::NodeOpened(UInt32 node)
 {
-	// Absolute value of horizontal and vertical distance from this node to the end node.
-	float dx = abs(static_cast<float>(node->coordinates_.x) - static_cast<float>(end_node->coordinates_.x)); // Casted to floats.
-	float dy = abs(static_cast<float>(node->coordinates_.y) - static_cast<float>(end_node->coordinates_.y));
-	return (dx + dy) + (kSquareRoot2 - 2) * std::min(dx, dy); // Takes diagonals in to account.
+	if (explored_states[node] == UNEXPLORED)
+	{
+		explored_squares.push_back(node);
+	}
+	explored_states[node] = IN_OPEN_SET;
+	changed_squares.push_back(node);
 }
 
-float PathfindingApp::ManhattanDistance(Vertex *node)
+void PathfindingApp::NodeClosed(UInt32 node)
 {
-	float dx = abs(static_cast<float>(node->coordinates_.x) - static_cast<float>(end_node->coordinates_.x));
-	float dy = abs(static_cast<float>(node->coordinates_.y) - static_cast<float>(end_node->coordinates_.y));
-	return dx + dy;
+	if (explored_states[node] == UNEXPLORED)
+	{
+		explored_squares.push_back(node);
+	}
+	explored_states[node] = IN_CLOSED_SET;
+	changed_squares.push_back(node);
 }
 
-std::vector<sf::RectangleShape> PathfindingApp::DrawPath(const std::list<Vertex*> path)
+std::vector<sf::RectangleShape> PathfindingApp::DrawPath(const std::vector<UInt32> &path)
 {
 	std::vector<sf::RectangleShape> path_line;
-	for (Vertex* node : path)
+	for (size_t i = 1; i < path.size(); i++) // Skips the start node, the path runs from it so each node's parent is the one before.
 	{
-		if (node->parent != nullptr) // If not the start node.
+		UInt32 node_x = graph.X(path[i]), node_y = graph.Y(path[i]);
+		UInt32 parent_x = graph.X(path[i - 1]), parent_y = graph.Y(path[i - 1]);
+		float x_difference = static_cast<float>(parent_x) - static_cast<float>(node_x); // We need to work these out to determine the direction of the path.
+		float y_difference = static_cast<float>(parent_y) - static_cast<float>(node_y);
+		if (x_difference == 0 && y_difference == 1) // Parent below.
 		{
-			float x_difference = static_cast<float>(node->parent->coordinates_.x) - static_cast<float>(node->coordinates_.x); // We need to work these out to determine the direction of the path.
-			float y_difference = static_cast<float>(node->parent->coordinates_.y) - static_cast<float>(node->coordinates_.y);
-			if (x_difference == 0 && y_difference == 1) // Parent below.
-			{
-				float x_pos = node->coordinates_.x*36.0f + 18.5f;
-				float y_pos = node->coordinates_.y*36.0f + 18.5f;
-				sf::RectangleShape line_segment(sf::Vector2f(4.0f, 36.0f));
-				line_segment.setPosition(sf::Vector2f(x_pos, y_pos)); // This should place this segment on the nodes position.
-				line_segment.setFillColor(sf::Color(0xFF, 0xFF, 0x00, 0xFF));
-				path_line.push_back(line_segment);
-			}
-			else if (x_difference == 0 && y_difference == -1) // Parent above.
-			{
-				float x_pos = node->coordinates_.x*36.0f + 18.5f;
-				float y_pos = node->coordinates_.y*36.0f + 18.5f;
-				sf::RectangleShape line_segment(sf::Vector2f(4.0f, 36.0f));
-				line_segment.setPosition(sf::Vector2f(x_pos, y_pos)); // This should place this segment on the nodes position.
-				line_segment.rotate(180); // Rotate 180 degrees so that it connects this node to it's parent.
-				line_segment.setFillColor(sf::Color(0xFF, 0xFF, 0x00, 0xFF));
-				path_line.push_back(line_segment);
-			}
-			else if (x_difference == 1 && y_difference == 0) // Parent to the right
-			{
-				float x_pos = node->coordinates_.x*36.0f + 18.5f;
-				float y_pos = node->coordinates_.y*36.0f + 18.5f;
-				sf::RectangleShape line_segment(sf::Vector2f(36.0f, 4.0f));
-				line_segment.setPosition(sf::Vector2f(x_pos, y_pos)); // This should place this segment on the nodes position.
-				line_segment.setFillColor(sf::Color(0xFF, 0xFF, 0x00, 0xFF));
-				path_line.push_back(line_segment);
-			}
-			else if (x_difference == -1 && y_difference == 0) // Parent to the left
-			{
-				float x_pos = node->coordinates_.x*36.0f + 18.5f;
-				float y_pos = node->coordinates_.y*36.0f + 18.5f;
-				sf::RectangleShape line_segment(sf::Vector2f(36.0f, 4.0f));
-				line_segment.setPosition(sf::Vector2f(x_pos, y_pos)); // This should place this segment on the nodes position.
-				line_segment.rotate(180);
-				line_segment.setFillColor(sf::Color(0xFF, 0xFF, 0x00, 0xFF));
-				path_line.push_back(line_segment);
-			}
-			else if (x_difference == 1 && y_difference == 1) // Parent bottom-right.
-			{
-				float x_pos = 18.5f + 36.0f*node->coordinates_.x;
-				float y_pos = 18.5f + 36.0f*node->coordinates_.y;
-				sf::RectangleShape line_segment(sf::Vector2f(kDiagonalDistance, 4.0f));
-				line_segment.setPosition(sf::Vector2f(x_pos, y_pos)); // This should place this segment on the nodes position.
-				line_segment.rotate(45);
-				line_segment.setFillColor(sf::Color(0xFF, 0xFF, 0x00, 0xFF));
-				path_line.push_back(line_segment);
-			}
-			else if (x_difference == -1 && y_difference == 1) // Parent bottom-left.
-			{
-				float x_pos = 18.5f + 36.0f*node->coordinates_.x;
-				float y_pos = 18.5f + 36.0f*node->coordinates_.y;
-				sf::RectangleShape line_segment(sf::Vector2f(kDiagonalDistance, 4.0f));
-				line_segment.setPosition(sf::Vector2f(x_pos, y_pos)); // This should place this segment on the nodes position.
-				line_segment.rotate(135);
-				line_segment.setFillColor(sf::Color(0xFF, 0xFF, 0x00, 0xFF));
-				path_line.push_back(line_segment);
-			}
-			else if (x_difference == -1 && y_difference == -1) // Parent top-left.
-			{
-				float x_pos = 18.5f + 36.0f*node->coordinates_.x;
-				float y_pos = 18.5f + 36.0f*node->coordinates_.y;
-				sf::RectangleShape line_segment(sf::Vector2f(kDiagonalDistance, 4.0f));
-				line_segment.setPosition(sf::Vector2f(x_pos, y_pos)); // This should place this segment on the nodes position.
-				line_segment.rotate(-135);
-				line_segment.setFillColor(sf::Color(0xFF, 0xFF, 0x00, 0xFF));
-				path_line.push_back(line_segment);
-			}
-			else if (x_difference == 1 && y_difference == -1) // Parent top-right.
-			{
-				float x_pos = 18.5f + 36.0f*node->coordinates_.x;
-				float y_pos = 18.5f + 36.0f*node->coordinates_.y;
-				sf::RectangleShape line_segment(sf::Vector2f(kDiagonalDistance, 4.0f));
-				line_segment.setPosition(sf::Vector2f(x_pos, y_pos)); // This should place this segment on the nodes position.
-				line_segment.rotate(-45);
-				line_segment.setFillColor(sf::Color(0xFF, 0xFF, 0x00, 0xFF));
-				path_line.push_back(line_segment);
-			}
+			float x_pos = node_x*kSquareSize + 18.5f;
+			float y_pos = node_y*kSquareSize + 18.5f;
+			sf::RectangleShape line_segment(sf::Vector2f(4.0f, kSquareSize));
+			line_segment.setPosition(sf::Vector2f(x_pos, y_pos)); // This should place this segment on the nodes position.
+			line_segment.setFillColor(sf::Color(0xFF, 0xFF, 0x00, 0xFF));
+			path_line.push_back(line_segment);
+		}
+		else if (x_difference == 0 && y_difference == -1) // Parent above.
+		{
+			float x_pos = node_x*kSquareSize + 18.5f;
+			float y_pos = node_y*kSquareSize + 18.5f;
+			sf::RectangleShape line_segment(sf::Vector2f(4.0f, kSquareSize));
+			line_segment.setPosition(sf::Vector2f(x_pos, y_pos)); // This should place this segment on the nodes position.
+			line_segment.rotate(180); // Rotate 180 degrees so that it connects this node to it's parent.
+			line_segment.setFillColor(sf::Color(0xFF, 0xFF, 0x00, 0xFF));
+			path_line.push_back(line_segment);
+		}
+		else if (x_difference == 1 && y_difference == 0) // Parent to the right
+		{
+			float x_pos = node_x*kSquareSize + 18.5f;
+			float y_pos = node_y*kSquareSize + 18.5f;
+			sf::RectangleShape line_segment(sf::Vector2f(kSquareSize, 4.0f));
+			line_segment.setPosition(sf::Vector2f(x_pos, y_pos)); // This should place this segment on the nodes position.
+			line_segment.setFillColor(sf::Color(0xFF, 0xFF, 0x00, 0xFF));
+			path_line.push_back(line_segment);
+		}
+		else if (x_difference == -1 && y_difference == 0) // Parent to the left
+		{
+			float x_pos = node_x*kSquareSize + 18.5f;
+			float y_pos = node_y*kSquareSize + 18.5f;
+			sf::RectangleShape line_segment(sf::Vector2f(kSquareSize, 4.0f));
+			line_segment.setPosition(sf::Vector2f(x_pos, y_pos)); // This should place this segment on the nodes position.
+			line_segment.rotate(180);
+			line_segment.setFillColor(sf::Color(0xFF, 0xFF, 0x00, 0xFF));
+			path_line.push_back(line_segment);
+		}
+		else if (x_difference == 1 && y_difference == 1) // Parent bottom-right.
+		{
+			float x_pos = 18.5f + kSquareSize*node_x;
+			float y_pos = 18.5f + kSquareSize*node_y;
+			sf::RectangleShape line_segment(sf::Vector2f(kDiagonalDistance, 4.0f));
+			line_segment.setPosition(sf::Vector2f(x_pos, y_pos)); // This should place this segment on the nodes position.
+			line_segment.rotate(45);
+			line_segment.setFillColor(sf::Color(0xFF, 0xFF, 0x00, 0xFF));
+			path_line.push_back(line_segment);
+		}
+		else if (x_difference == -1 && y_difference == 1) // Parent bottom-left.
+		{
+			float x_pos = 18.5f + kSquareSize*node_x;
+			float y_pos = 18.5f + kSquareSize*node_y;
+			sf::RectangleShape line_segment(sf::Vector2f(kDiagonalDistance, 4.0f));
+			line_segment.setPosition(sf::Vector2f(x_pos, y_pos)); // This should place this segment on the nodes position.
+			line_segment.rotate(135);
+			line_segment.setFillColor(sf::Color(0xFF, 0xFF, 0x00, 0xFF));
+			path_line.push_back(line_segment);
+		}
+		else if (x_difference == -1 && y_difference == -1) // Parent top-left.
+		{
+			float x_pos = 18.5f + kSquareSize*node_x;
+			float y_pos = 18.5f + kSquareSize*node_y;
+			sf::RectangleShape line_segment(sf::Vector2f(kDiagonalDistance, 4.0f));
+			line_segment.setPosition(sf::Vector2f(x_pos, y_pos)); // This should place this segment on the nodes position.
+			line_segment.rotate(-135);
+			line_segment.setFillColor(sf::Color(0xFF, 0xFF, 0x00, 0xFF));
+			path_line.push_back(line_segment);
+		}
+		else if (x_difference == 1 && y_difference == -1) // Parent top-right.
+		{
+			float x_pos = 18.5f + kSquareSize*node_x;
+			float y_pos = 18.5f + kSquareSize*node_y;
+			sf::RectangleShape line_segment(sf::Vector2f(kDiagonalDistance, 4.0f));
+			line_segment.setPosition(sf::Vector2f(x_pos, y_pos)); // This should place this segment on the nodes position.
+			line_segment.rotate(-45);
+			line_segment.setFillColor(sf::Color(0xFF, 0xFF, 0x00, 0xFF));
+			path_line.push_back(line_segment);
 		}
 	}
 	return path_line;
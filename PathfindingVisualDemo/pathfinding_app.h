@@ -3,43 +3,135 @@
 #include <vector>
 #include <string>
 #include "pathfinding.h"
-#include "pathfinding_app.h"
+#include "hierarchical_search.h"
+#include "d_star_lite.h"
+#include "path_cache.h"
+#include "connected_components.h"
+#include "search_worker.h"
+#include "search_trace.h"
 
+const float kSquareSize = 36.0f; // Distance between squares in map coordinates, each square is 1 less than this so the grid lines show.
+const float kMaxVisibleSquares = 512.0f; // Widest the view can be zoomed out to, in squares, the vertices for a view this size are about 20MB.
+const UInt32 kMaxGridSize = 16384; // Largest width/height that can be given on the command line.
+const float kDiagonalDistance = 52.9116882454f;
+const UInt32 kPauseIncrement = 25;
+const char *const kSavedMapFile = "saved_map.grid"; // Written when <F5> is pressed, and can be opened again from the command line.
+const char *const kTraceFile = "searches.trace"; // Written while <R> has recording on, and can be replayed by giving it on the command line.
+const sf::Color colour_blocked = sf::Color(0x66, 0x66, 0x66, 0xFF);
+const sf::Color colour_open_set = sf::Color(0x00, 0x33, 0xCC, 0x66);
+const sf::Color colour_closed_set = sf::Color(0x99, 0xFF, 0xCC, 0x66);
+const sf::Color colour_background = sf::Color(0xF9, 0xF9, 0xF9, 0xFF);
+const sf::Color colour_grid_lines = sf::Color(0xB1, 0xB1, 0xB1, 0xFF); // The old outline colour over the background.
+const int kPanelLineCount = 18; // Lines of text in the top left panel.
+enum PanelLine { BRUSH_LINE = 10, PAUSE_LINE, PATH_LENGTH_LINE, DURATION_LINE, MOVEMENT_LINE, SEARCH_COUNTS_LINE, SEARCH_COSTS_LINE, TRACE_LINE }; // The ones before are instructions.
+
+struct Terrain // A kind of ground that can be painted on the map, the cost is what it costs to move in to a square of it.
+{
+	const char *name;
+	UInt8 cost;
+	sf::Color colour;
+};
+const int kTerrainCount = 4;
+const Terrain kTerrains[kTerrainCount] = { // Ordered by cost, painted with the number keys from <1>.
+	{ "Road", 1, sf::Color::Transparent },
+	{ "Grass", 2, sf::Color(0xC5, 0xE3, 0xA4, 0xFF) },
+	{ "Mud", 4, sf::Color(0xB8, 0x93, 0x6C, 0xFF) },
+	{ "Water", 8, sf::Color(0x8F, 0xB8, 0xE6, 0xFF) } };
+const int kObstacleBrush = -1; // The left mouse button draws obstacles instead of terrain, selected with <0>.
+enum ExploredState : UInt8 { UNEXPLORED, IN_OPEN_SET, IN_CLOSED_SET }; // Where a square got to in the search being shown.
+
+// The search runs on a SearchWorker, and the app plays back the squares it opens and closes to draw the progress of
+// the algorithm, so the window stays responsive however slowly it is played.
 class PathfindingApp
 {
 private:
-	Grid graph; // Our 26x20 grid/graph.
-	Vertex *start_node;
-	Vertex *end_node;
-	Algorithm current_algorithm; // A value to determine what algorithm to use.
 	sf::RenderWindow window;
-	sf::RectangleShape squares[26][20];
+	Grid graph; // Our grid/graph, 26x20 unless a size or map file is given on the command line.
+	SearchState search_state; // Reused by every search.
+	HierarchicalPathfinder hierarchy; // Built the first time HPA* is run, then kept up to date as obstacles are drawn.
+	ConnectedComponents components; // Which squares can reach each other, so an unreachable end is known without a search.
+	PathCache path_cache; // Running the same search again before anything is drawn shows the remembered path straight away.
+	Landmarks landmarks; // Built when A* (Landmarks) is run, and again the next time it is run after obstacles are drawn.
+	DStarLite replanner; // Keeps the last D* Lite search, so running it again only repairs what the drawn obstacles changed.
+	SearchTraceWriter trace_writer; // Open while <R> has recording on, the worker records each search through it.
+	Algorithm current_algorithm; // A value to determine what algorithm to use.
+	SearchWorker search_worker; // Destroyed before everything the search uses, which is declared above it.
+	UInt64 cache_hits; // Path cache hits before the running search was started.
+	float playback_budget; // Closed squares that can still be shown before the playback has caught up with the clock.
+	sf::Clock frame_clock;
+	std::vector<SearchTrace> traces; // From the trace file given on the command line, replayed with <T>.
+	size_t trace_index; // The search being replayed, traces.size() if none is.
+	size_t trace_position; // Events of it shown so far.
+	std::string trace_message; // Shown on the trace line when recording or replaying could not be done, until <R> or <T> is pressed again.
+	std::vector<ExploredState> explored_states; // By grid index, whether a square is blocked and its terrain come from the grid.
+	std::vector<UInt32> explored_squares; // The squares that are not UNEXPLORED, so clearing them doesn't look at the rest of the map.
+	// Each frame is made of these layers, the size of the window, and each is only drawn again when what is on it changes.
+	sf::RenderTexture terrain_layer; // Grid lines, terrain and obstacles.
+	sf::RenderTexture explored_layer; // The open and closed sets, see through so the terrain shows underneath.
+	sf::RenderTexture path_layer; // The start, end and path.
+	sf::RenderTexture text_layer; // The panels and their text, in window coordinates.
+	sf::VertexArray layer_quads; // Reused to draw squares in to the layers.
+	sf::Vector2f layer_view_centre, layer_view_size; // The view the grid layers were drawn with.
+	bool grid_layers_stale; // The terrain, explored and path layers have to be drawn again from scratch.
+	bool path_layer_stale, text_layer_stale;
+	std::vector<UInt32> changed_squares; // Squares painted, opened or closed since the last frame, only these are drawn again.
+	sf::View grid_view; // The part of the map that is on screen, this can be panned and zoomed.
 	sf::RectangleShape panels[2];
 	sf::Font font;
-	std::string str_path_length;
-	std::string str_pause_duration;
-	std::string str_algorithm_duration;
-	sf::Text text_dijkstras, text_astar_manhatten, text_astar_diagonal;
+	sf::Text panel_lines[kPanelLineCount];
+	std::string panel_strings[kPanelLineCount]; // What each line shows, it is only laid out again when this changes.
+	int shown_algorithm; // The algorithm shown in red in the list.
+	sf::Text text_algorithms[kAlgorithmCount]; // The names of the algorithms to choose from.
 	std::vector<sf::RectangleShape> path_line;
 	float path_length;
 	float algorithm_duration;
 	bool start_selected, end_selected, path_found;
-	int start_x, start_y;
-	int end_x, end_y;
+	bool stroke_started; // The mouse has edited since a button went down, and stroke_x, stroke_y is the last square it was over.
+	UInt32 stroke_x, stroke_y;
+	UInt32 start_x, start_y;
+	UInt32 end_x, end_y;
 	int speed_multiplier;
+	UInt32 nodes_expanded; // From the last search.
+	SearchStats search_stats; // Likewise.
+	bool result_cached; // The last search came from the path cache.
+	UInt64 shown_cache_hits, shown_cache_misses; // The path cache's counts as the last result was taken, the worker changes them as it searches.
+	int brush; // What the left mouse button paints, an index in to kTerrains or kObstacleBrush.
 
 public:
-	PathfindingApp();
+	PathfindingApp(const Grid &map);
 	~PathfindingApp();
 
+	void SetTraces(std::vector<SearchTrace> searches); // Every search must be on a grid the size of the map.
 	void Run();
-	Grid InitialiseGrid();
 	void Draw();
 	void ClearGrid();
-	std::list<Vertex*> DijkstrasAlgorithm();
-	std::list<Vertex*> AStarAlgorithm();
-	float DiagonalDistance(Vertex* node);
-	float ManhattanDistance(Vertex* node);
-	std::vector<sf::RectangleShape> DrawPath(const std::list<Vertex*> path);
+	void SetPanelLine(int line, const std::string &string);
+	sf::Color TerrainColour(UInt32 index) const; // The ground the square shows, or the obstacle on it.
+	sf::Color ExploredColour(UInt32 index) const; // Transparent unless the square is in the open or closed set.
+	void UpdateGridLayers(UInt32 min_x, UInt32 min_y, UInt32 max_x, UInt32 max_y);
+	void DrawTextLayer();
+	bool EditSquare(UInt32 index, bool blocked, UInt8 cost); // How the map is edited, returns false if the square was like that already.
+	void SquareChanged(UInt32 index, UInt64 previous_version); // Tells everything that is kept up to date with the grid that this square has changed, previous_version is from before.
+	bool SquareAt(int pixel_x, int pixel_y, UInt32 &x, UInt32 &y) const; // False if the point in the window is off the map.
+	void MouseEdit(int pixel_x, int pixel_y); // Called for each mouse event with a button held down.
+	void EditAt(UInt32 x, UInt32 y); // What the mouse buttons held down do to this square.
+	void CycleMovement(); // 4-connected, then 8-connected with each corner cutting rule in turn.
+	UInt32 FreeSquareFrom(UInt32 index, UInt32 other) const;
+	void VisibleSquares(UInt32 &min_x, UInt32 &min_y, UInt32 &max_x, UInt32 &max_y) const;
+	void ZoomView(float factor);
+	void PanView(float x_fraction, float y_fraction);
+	void RunAlgorithm(); // Starts the search on the worker thread.
+	void StopSearch(); // Cancels the running search, if there is one, and waits for it.
+	void PlaySearch(float seconds); // Shows the progress of the running search over this many seconds, and its result at the end.
+	void ShowResult(const SearchResult &result);
+	SearchResult RunSearch(Algorithm algorithm, UInt32 start, UInt32 end, SearchObserver *observer); // On the worker thread.
+	void ToggleRecording();
+	void ReplayNextTrace();
+	void StopReplay();
+	void PlayTrace(float seconds); // Like PlaySearch() for the search being replayed.
+	void SeekTrace(size_t position); // Shows the replayed search as it was after this many events.
+	void NodeOpened(UInt32 node);
+	void NodeClosed(UInt32 node);
+	std::vector<sf::RectangleShape> DrawPath(const std::vector<UInt32> &path);
 };
 
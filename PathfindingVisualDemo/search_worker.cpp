@@ -0,0 +1,67 @@
+#include "search_worker.h"
+
+SearchWorker::SearchWorker()
+	: events_(kQueueCapacity), finished_(false), cancelled_(false)
+{
+}
+
+SearchWorker::~SearchWorker()
+{
+	if (Running())
+	{
+		Cancel();
+		thread_.join();
+	}
+}
+
+void SearchWorker::Start(std::function<SearchResult(SearchObserver *observer)> search)
+{
+	if (Running())
+	{
+		Cancel();
+		TakeResult();
+	}
+	events_.Clear();
+	finished_.store(false);
+	cancelled_.store(false);
+	thread_ = std::thread([this, search]()
+	{
+		result_ = search(this);
+		finished_.store(true, std::memory_order_release);
+	});
+}
+
+bool SearchWorker::NextEvent(UInt32 &node, bool &closed)
+{
+	UInt32 event;
+	if (!events_.Pop(event))
+	{
+		return false;
+	}
+	node = event & ~kClosedFlag;
+	closed = (event & kClosedFlag) != 0;
+	return true;
+}
+
+SearchResult SearchWorker::TakeResult()
+{
+	thread_.join();
+	return result_;
+}
+
+void SearchWorker::Cancel()
+{
+	cancelled_.store(true, std::memory_order_relaxed);
+	UInt32 event;
+	while (events_.Pop(event)) // Frees the worker if it is waiting on a full queue.
+	{
+	}
+}
+
+void SearchWorker::Publish(UInt32 event)
+{
+	while (!cancelled_.load(std::memory_order_relaxed) && !events_.Push(event))
+	{
+		std::this_thread::yield(); // The render thread is behind, wait for it to take some events.
+	}
+}
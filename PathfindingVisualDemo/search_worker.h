@@ -0,0 +1,47 @@
+#pragma once
+#include <thread>
+#include <atomic>
+#include <functional>
+#include "pathfinding.h"
+#include "spsc_queue.h"
+
+// Runs one search at a time on a thread of its own, so the window keeps drawing and handling events while it runs.
+// The search's progress is published as events through a single producer, single consumer queue, and the render thread
+// plays them back at whatever rate it likes. When the queue is full the search waits for the render thread to catch up,
+// so at a slow playback rate the search's duration includes that wait, as it always included time in the observer.
+//
+// Nothing the search reads (the grid and whatever else the search function uses) may be changed until the result has
+// been taken.
+class SearchWorker : private SearchObserver
+{
+public:
+	static const size_t kQueueCapacity = 1 << 20; // Events, 4 bytes each.
+	static const UInt32 kClosedFlag = 0x80000000; // Set on the events for closed nodes, grid indices never get this high.
+
+	SearchWorker();
+	~SearchWorker(); // Cancels a search that is still running.
+
+	// The search is given the observer to report its progress to, and must not be given it after it returns.
+	void Start(std::function<SearchResult(SearchObserver *observer)> search);
+	bool Running() const { return thread_.joinable(); }; // Started and the result not taken yet.
+	// For the render thread. Takes the next event if there is one, the node is opened unless closed is set.
+	bool NextEvent(UInt32 &node, bool &closed);
+	bool Finished() const { return finished_.load(std::memory_order_acquire) && events_.Empty(); }; // Searched and every event taken.
+	SearchResult TakeResult(); // Waits for the search to finish if it hasn't.
+	// The events not yet taken are dropped, and the search stops at the next node it closes, so TakeResult() returns
+	// about as soon as it is called. A search that does not ask its observer whether it is cancelled runs to the end
+	// without publishing.
+	void Cancel();
+
+private:
+	void NodeOpened(UInt32 node) override { Publish(node); };
+	void NodeClosed(UInt32 node) override { Publish(node | kClosedFlag); };
+	bool Cancelled() const override { return cancelled_.load(std::memory_order_relaxed); };
+	void Publish(UInt32 event);
+
+	std::thread thread_;
+	SpscQueue<UInt32> events_;
+	std::atomic<bool> finished_; // Set by the worker once the search has returned and every event has been pushed.
+	std::atomic<bool> cancelled_;
+	SearchResult result_; // Written by the worker before finished_ is set.
+};